@@ -0,0 +1,83 @@
+// Time and heap use of parsing a large minified document from a std::string.
+// Build it once against the current header and once against an older one to compare them, e.g.
+//   g++ -std=c++11 -O2 bench/inplace_bench.cpp -o inplace_new
+//   git show <commit>:json.hpp > /tmp/json_old.hpp
+//   g++ -std=c++11 -O2 -DJSON_BENCH_HEADER='"/tmp/json_old.hpp"' bench/inplace_bench.cpp -o inplace_old
+// Usage: inplace_bench [megabytes] [iterations]
+
+#ifndef JSON_BENCH_HEADER
+#define JSON_BENCH_HEADER "../json.hpp"
+#endif
+#include JSON_BENCH_HEADER
+
+#include <chrono>
+#include <cstdio>
+#include <new>
+
+// Every heap block carries its size in front of it, so live and peak heap bytes can be tracked.
+static size_t liveBytes = 0;
+static size_t peakBytes = 0;
+
+void* operator new(size_t size) {
+    size_t* block = static_cast<size_t*>(std::malloc(size + sizeof(size_t) * 2));
+    if (!block)
+        throw std::bad_alloc();
+    block[0] = size;
+    liveBytes += size;
+    if (liveBytes > peakBytes)
+        peakBytes = liveBytes;
+    return block + 2;
+}
+
+void operator delete(void* p) noexcept {
+    if (!p)
+        return;
+    size_t* block = static_cast<size_t*>(p) - 2;
+    liveBytes -= block[0];
+    std::free(block);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    operator delete(p);
+}
+
+// Array of records shaped like a typical API response, without any whitespace.
+static std::string makeDocument(size_t bytes) {
+    std::string text = "[";
+    char record[256];
+    for (unsigned i = 0; text.size() < bytes; ++i) {
+        snprintf(record, sizeof(record),
+                 "%s{\"id\":%u,\"name\":\"item %u\",\"price\":%u.%02u,\"tags\":[\"a\",\"b\"],\"active\":%s,\"parent\":null}",
+                 i ? "," : "", i, i, i % 1000, i % 100, i % 2 ? "true" : "false");
+        text += record;
+    }
+    text += "]";
+    return text;
+}
+
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? strtoul(argv[1], nullptr, 10) : 32;
+    int iterations = argc > 2 ? atoi(argv[2]) : 5;
+
+    std::string text = makeDocument(megabytes << 20);
+    double best = 1e300;
+    size_t transient = 0;
+    size_t retained = 0;
+    for (int i = 0; i < iterations; ++i) {
+        size_t before = liveBytes;
+        peakBytes = liveBytes;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        JSON json = JSONParser::parse(text);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (seconds < best)
+            best = seconds;
+        retained = liveBytes - before;
+        transient = peakBytes - liveBytes;
+    }
+
+    printf("input        %10.1f MB\n", text.size() / 1048576.0);
+    printf("parse        %10.1f ms  (%.0f MB/s, best of %d)\n", best * 1000, text.size() / 1048576.0 / best, iterations);
+    printf("tree         %10.1f MB  heap kept by the result\n", retained / 1048576.0);
+    printf("peak extra   %10.1f MB  heap used during parsing on top of the result\n", transient / 1048576.0);
+    return 0;
+}
@@ -0,0 +1,61 @@
+// Cost of line/column tracking: parse time of a large minified document, and the time to report an error at
+// its very end, where the position has to be worked out over the whole input.
+// Build it against two versions of the header to compare them, see inplace_bench.cpp:
+//   g++ -std=c++11 -O2 bench/position_bench.cpp -o position_new
+//   g++ -std=c++11 -O2 -DJSON_BENCH_HEADER='"/tmp/json_old.hpp"' bench/position_bench.cpp -o position_old
+// Usage: position_bench [megabytes] [iterations]
+
+#ifndef JSON_BENCH_HEADER
+#define JSON_BENCH_HEADER "../json.hpp"
+#endif
+#include JSON_BENCH_HEADER
+
+#include <chrono>
+#include <cstdio>
+
+static std::string makeDocument(size_t bytes) {
+    std::string text = "[";
+    char record[256];
+    for (unsigned i = 0; text.size() < bytes; ++i) {
+        snprintf(record, sizeof(record), "%s{\"id\":%u,\"name\":\"item %u\",\"values\":[%u,%u,%u],\"flag\":%s}",
+                 i ? "," : "", i, i, i, i * 7, i * 13, i % 2 ? "true" : "false");
+        text += record;
+    }
+    text += "]";
+    return text;
+}
+
+// Best time of iterations runs of parsing text, in milliseconds. message receives the error, if any.
+static double timeParse(const std::string& text, int iterations, std::string& message) {
+    double best = 1e300;
+    for (int i = 0; i < iterations; ++i) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        try {
+            JSON json = JSONParser::parse(text);
+        } catch (const std::exception& e) {
+            message = e.what();
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (ms < best)
+            best = ms;
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? strtoul(argv[1], nullptr, 10) : 32;
+    int iterations = argc > 2 ? atoi(argv[2]) : 5;
+
+    std::string valid = makeDocument(megabytes << 20);
+    std::string broken = valid;
+    broken[broken.size() - 1] = '}';
+
+    std::string message;
+    double parseMs = timeParse(valid, iterations, message);
+    double errorMs = timeParse(broken, iterations, message);
+
+    printf("input        %10.1f MB\n", valid.size() / 1048576.0);
+    printf("parse        %10.1f ms  (%.0f MB/s, best of %d)\n", parseMs, valid.size() / 1048576.0 / parseMs * 1000, iterations);
+    printf("error at end %10.1f ms  %s\n", errorMs, message.c_str());
+    return 0;
+}
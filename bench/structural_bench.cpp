@@ -0,0 +1,88 @@
+// Throughput of Options::structuralIndex against the default parser, for events only and for building the tree,
+// on a minified and an indented document. The machine should be otherwise idle, the best of several runs is shown.
+//   g++ -std=c++11 -O2 -march=native bench/structural_bench.cpp -o structural_bench
+// Usage: structural_bench [megabytes] [iterations]
+
+#ifndef JSON_BENCH_HEADER
+#define JSON_BENCH_HEADER "../json.hpp"
+#endif
+#include JSON_BENCH_HEADER
+
+#include <chrono>
+#include <cstdio>
+
+// Log records with a few short strings, numbers and a nested array. indent adds a newline and spaces per member.
+static std::string makeDocument(size_t bytes, bool indent) {
+    const char* separator = indent ? "\n    " : "";
+    std::string text = "[";
+    char record[512];
+    for (unsigned i = 0; text.size() < bytes; ++i) {
+        snprintf(record, sizeof(record),
+                 "%s%s{\"ts\":%u,%s\"level\":\"%s\",%s\"service\":\"api-%u\",%s\"message\":\"request %u handled in %u ms\","
+                 "%s\"latency\":%u.%02u,%s\"ok\":%s,%s\"tags\":[\"http\",\"v%u\"]}",
+                 i ? "," : "", separator, 1700000000 + i, separator, i % 7 ? "info" : "warn", separator, i % 16,
+                 separator, i, i % 250, separator, i % 250, i % 100, separator, i % 13 ? "true" : "false",
+                 separator, i % 3);
+        text += record;
+    }
+    text += "]";
+    return text;
+}
+
+struct CountHandler : JSONHandler {
+    size_t values = 0;
+    bool null() { values++; return true; }
+    bool boolean(bool) { values++; return true; }
+    bool integer(int64_t) { values++; return true; }
+    bool unsignedInteger(uint64_t) { values++; return true; }
+    bool number(double) { values++; return true; }
+    bool string(const char*, size_t) { values++; return true; }
+};
+
+// Best throughput of iterations runs in MB/s.
+template<typename Parse>
+static double measure(const std::string& text, int iterations, Parse parse) {
+    double best = 1e300;
+    for (int i = 0; i < iterations; ++i) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        parse();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (seconds < best)
+            best = seconds;
+    }
+    return text.size() / 1048576.0 / best;
+}
+
+// One parser per mode is reused for every run, as when reading a stream of documents, so the index buffer is
+// allocated once.
+static void run(const char* name, const std::string& text, int iterations) {
+    double rates[4];
+    for (int i = 0; i < 2; ++i) {
+        JSONParser::Options options;
+        options.structuralIndex = i == 1;
+        JSONParser parser;
+        JSON json;
+        rates[i * 2] = measure(text, iterations, [&] {
+            CountHandler handler;
+            parser.reset(text.data(), text.size());
+            parser.read(handler, options);
+        });
+        rates[i * 2 + 1] = measure(text, iterations, [&] {
+            parser.reset(text.data(), text.size());
+            parser.read(json, options);
+        });
+    }
+
+    printf("%-9s %7.1f MB   events %6.0f -> %6.0f MB/s   tree %6.0f -> %6.0f MB/s\n",
+           name, text.size() / 1048576.0, rates[0], rates[2], rates[1], rates[3]);
+}
+
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? strtoul(argv[1], nullptr, 10) : 32;
+    int iterations = argc > 2 ? atoi(argv[2]) : 15;
+
+    printf("default -> structuralIndex, best of %d\n", iterations);
+    run("minified", makeDocument(megabytes << 20, false), iterations);
+    run("indented", makeDocument(megabytes << 20, true), iterations);
+    return 0;
+}
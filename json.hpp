@@ -3,6 +3,7 @@
 // For those who do not want to include json library heavier than small codebase itself.
 // Define JSON_DISABLE_DUMPING to not generate JSON::dump() and related methods if you don't need it. 
 // This will help to reduce size of the compiled binary.
+// Define JSON_DISABLE_THREADS to leave out the multi-threaded parsers and the <thread> dependency.
 
 #ifndef __JSON_HPP__
 #define __JSON_HPP__
@@ -17,41 +18,255 @@
 #include <cctype>
 #include <iomanip>
 #include <type_traits>
+#include <memory>
+#include <cstdint>
+#include <cstdlib>
+#include <cerrno>
+#include <clocale>
+#include <cmath>
+#include <climits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define JSON_HAS_MMAP
+#endif
+
+// Define JSON_DISABLE_SIMD to force the scalar fallback of the structural indexer.
+#ifndef JSON_DISABLE_SIMD
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define JSON_HAS_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define JSON_HAS_SSE2
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define JSON_HAS_SSSE3
+#endif
+#endif
+#if defined(__PCLMUL__)
+#include <wmmintrin.h>
+#define JSON_HAS_PCLMUL
+#endif
+// GCC and Clang can add AVX2 and SSSE3 functions to a build that only assumes SSE2, the UTF-8 validator picks the
+// widest one the CPU supports at runtime.
+#if defined(JSON_HAS_SSE2) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define JSON_HAS_DISPATCH
+#define JSON_TARGET(features) __attribute__((target(features)))
+#endif
+#endif
+
+#ifndef JSON_TARGET
+#define JSON_TARGET(features)
+#endif
+
+#ifndef JSON_DISABLE_THREADS
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <deque>
+#include <exception>
+#endif
 
 // #define JSON_DISABLE_DUMPING
 
 template<typename T, typename Enable = void>
 struct JSONTypeTraits;
 
+// Validated input and container index shared by all values of a lazily parsed document.
+struct JSONLazyDocument {
+    struct Container {
+        size_t start;       // Offset of the opening bracket.
+        size_t end;         // Offset of the closing bracket.
+        size_t descendants; // Containers nested inside, the next sibling's entry follows them.
+    };
+
+    std::string text;
+    std::vector<Container> containers; // In document order.
+};
+
+class JSON;
+
+struct JSONLazyRef {
+    JSONLazyRef(const std::shared_ptr<const JSONLazyDocument>& document, size_t container)
+    : document(document), container(container) {}
+
+    std::shared_ptr<const JSONLazyDocument> document;
+    size_t container;
+    // The array or object, built on the first const access. The JSON pointing here stays Lazy, so reading
+    // through a const reference never changes it.
+    mutable std::unique_ptr<JSON> value;
+#ifndef JSON_DISABLE_THREADS
+    mutable std::once_flag built;
+#endif
+};
+
+// Characters of a string value. Owned strings keep them right behind this header in the same allocation,
+// borrowed ones point into a buffer owned by someone else, see JSONDocument::parseInsitu().
+struct JSONStringRef {
+    const char* data;
+    size_t size;
+};
+
+// Monotonic allocator behind JSONDocument. Memory is handed out from a few large blocks and is only given back
+// when the arena is reset or destroyed, deallocate is a no-op.
+class JSONArena {
+public:
+    explicit JSONArena(size_t blockSize = 64 * 1024) : head(nullptr), cursor(nullptr), limit(nullptr), blockSize(blockSize) {}
+    JSONArena(const JSONArena&) = delete;
+    JSONArena& operator=(const JSONArena&) = delete;
+
+    ~JSONArena() {
+        while (head) {
+            Block* next = head->next;
+            std::free(head);
+            head = next;
+        }
+    }
+
+    void* allocate(size_t size, size_t align) {
+        uintptr_t p = (reinterpret_cast<uintptr_t>(cursor) + align - 1) & ~static_cast<uintptr_t>(align - 1);
+        uintptr_t end = reinterpret_cast<uintptr_t>(limit);
+        // Rounding up can carry p past the end of a block that was filled almost exactly.
+        if (!cursor || p > end || size > end - p)
+            return grow(size, align);
+        cursor = reinterpret_cast<char*>(p + size);
+        return reinterpret_cast<void*>(p);
+    }
+
+    // Releases every block except the newest, which is the largest and is kept for the next document.
+    void reset() {
+        if (!head)
+            return;
+
+        Block* block = head->next;
+        while (block) {
+            Block* next = block->next;
+            std::free(block);
+            block = next;
+        }
+        head->next = nullptr;
+        cursor = reinterpret_cast<char*>(head + 1);
+    }
+
+    size_t capacity() const {
+        size_t total = 0;
+        for (Block* block = head; block; block = block->next)
+            total += block->size;
+        return total;
+    }
+
+private:
+    struct Block {
+        Block* next;
+        size_t size;
+    };
+
+    Block* head;
+    char* cursor;
+    char* limit;
+    size_t blockSize; // Size of the next block, doubles up to 16 MB.
+
+    void* grow(size_t size, size_t align) {
+        size_t needed = sizeof(Block) + size + align;
+        size_t length = needed > blockSize ? needed : blockSize;
+        Block* block = static_cast<Block*>(std::malloc(length));
+        if (!block)
+            throw std::bad_alloc();
+
+        block->next = head;
+        block->size = length;
+        head = block;
+        cursor = reinterpret_cast<char*>(block + 1);
+        limit = reinterpret_cast<char*>(block) + length;
+        if (blockSize < 16 * 1024 * 1024)
+            blockSize *= 2;
+        return allocate(size, align);
+    }
+};
+
+// Allocator of the containers inside JSON. Without an arena it is a plain heap allocator, with one every
+// allocation comes from the arena. Copies of a container always go back to the heap.
+template<typename T>
+struct JSONAllocator {
+    typedef T value_type;
+
+    JSONArena* arena;
+
+    JSONAllocator() : arena(nullptr) {}
+    explicit JSONAllocator(JSONArena* arena) : arena(arena) {}
+    template<typename U>
+    JSONAllocator(const JSONAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) {
+        if (arena)
+            return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t) {
+        if (!arena)
+            ::operator delete(p);
+    }
+
+    JSONAllocator select_on_container_copy_construction() const { return JSONAllocator(); }
+
+    template<typename U>
+    bool operator==(const JSONAllocator<U>& other) const { return arena == other.arena; }
+    template<typename U>
+    bool operator!=(const JSONAllocator<U>& other) const { return arena != other.arena; }
+};
+
 class JSON {
 public:
     enum Type {
         Null,
         Boolean,
         Integer,
+        UnsignedInteger, // Only used for values above INT64_MAX.
         Double,
         String,
         Array,
-        Object
+        Object,
+        Lazy // Array or object that is parsed on first access, see JSONParser::parseLazy().
     };
 
+    typedef std::basic_string<char, std::char_traits<char>, JSONAllocator<char>> StringType;
+    typedef std::vector<JSON, JSONAllocator<JSON>> ArrayType;
+    typedef std::map<StringType, JSON, std::less<StringType>, JSONAllocator<std::pair<const StringType, JSON>>> ObjectType;
+
     static JSON o(std::initializer_list<std::pair<std::string, JSON>> list) {
         std::map<std::string, JSON> obj;
         for (const auto& pair : list) {
             obj[pair.first] = pair.second;
         }
-        return JSON(obj);
+        return JSON(std::move(obj));
     }
 
     JSON() : type(Null) {}
     JSON(bool b) : type(Boolean), boolean(b) {}
     JSON(int i) : type(Integer), integer(i) {}
+    JSON(long i) : type(Integer), integer(i) {}
+    JSON(long long i) : type(Integer), integer(i) {}
+    JSON(unsigned int u) : type(Integer), integer(u) {}
+    JSON(unsigned long u) : type(u > INT64_MAX ? UnsignedInteger : Integer), unsignedInteger(u) {}
+    JSON(unsigned long long u) : type(u > INT64_MAX ? UnsignedInteger : Integer), unsignedInteger(u) {}
     JSON(double d) : type(Double), doubleVal(d) {}
-    JSON(const char* s) : type(String), string(new std::string(s)) {}
-    JSON(const std::string& s) : type(String), string(new std::string(s)) {}
-    JSON(const std::vector<JSON>& a) : type(Array), array(new std::vector<JSON>(a)) {}
-    JSON(std::initializer_list<JSON> list) : type(Array), array(new std::vector<JSON>(list)) {}
-    JSON(const std::map<std::string, JSON>& obj) : type(Object), object(new std::map<std::string, JSON>(obj)) {}
+    JSON(const char* s) : type(String), ref(newString(s, strlen(s))) {}
+    JSON(const std::string& s) : type(String), ref(newString(s.data(), s.size())) {}
+    JSON(const std::vector<JSON>& a) : type(Array), array(new ArrayType(a.begin(), a.end())) {}
+    JSON(std::initializer_list<JSON> list) : type(Array), array(new ArrayType(list)) {}
+    JSON(const std::map<std::string, JSON>& obj) : type(Object), object(copyObject(obj)) {}
+    // Elements and values are moved, only object keys are copied since JSON keeps its own string type.
+    JSON(std::vector<JSON>&& a)
+    : type(Array), array(new ArrayType(std::make_move_iterator(a.begin()), std::make_move_iterator(a.end()))) {}
+    JSON(std::map<std::string, JSON>&& obj) : type(Object), object(moveObject(obj)) {}
 
     ~JSON() {
         clear();
@@ -61,9 +276,14 @@ public:
         copy(other);
     }
 
+    // Containers relocate their elements with this, so values built in an arena never get copied to the heap.
+    JSON(JSON&& other) noexcept : type(other.type) {
+        take(other);
+    }
+
     template<typename T>
     T as() const {
-        return JSONTypeTraits<T>::as(*this);
+        return JSONTypeTraits<T>::as(resolved());
     }
 
 #ifndef JSON_DISABLE_DUMPING
@@ -73,11 +293,24 @@ public:
     }
 #endif
 
+    // other may live inside this value, as in j = std::move(j["data"]), so it is copied or moved out before
+    // this value is cleared.
     JSON& operator=(const JSON& other) {
         if (this != &other) {
+            JSON value(other);
+            clear();
+            type = value.type;
+            take(value);
+        }
+        return *this;
+    }
+
+    JSON& operator=(JSON&& other) noexcept {
+        if (this != &other) {
+            JSON value(std::move(other));
             clear();
-            type = other.type;
-            copy(other);
+            type = value.type;
+            take(value);
         }
         return *this;
     }
@@ -96,6 +329,41 @@ public:
         return *this;
     }
 
+    JSON& operator=(long i) {
+        clear();
+        type = Integer;
+        integer = i;
+        return *this;
+    }
+
+    JSON& operator=(long long i) {
+        clear();
+        type = Integer;
+        integer = i;
+        return *this;
+    }
+
+    JSON& operator=(unsigned int u) {
+        clear();
+        type = Integer;
+        integer = u;
+        return *this;
+    }
+
+    JSON& operator=(unsigned long u) {
+        clear();
+        type = u > INT64_MAX ? UnsignedInteger : Integer;
+        unsignedInteger = u;
+        return *this;
+    }
+
+    JSON& operator=(unsigned long long u) {
+        clear();
+        type = u > INT64_MAX ? UnsignedInteger : Integer;
+        unsignedInteger = u;
+        return *this;
+    }
+
     JSON& operator=(double d) {
         clear();
         type = Double;
@@ -106,43 +374,61 @@ public:
     JSON& operator=(const char* s) {
         clear();
         type = String;
-        string = new std::string(s);
+        ref = newString(s, strlen(s));
         return *this;
     }
 
     JSON& operator=(const std::string& s) {
         clear();
         type = String;
-        string = new std::string(s);
+        ref = newString(s.data(), s.size());
         return *this;
     }
 
     JSON& operator=(const std::vector<JSON>& a) {
         clear();
         type = Array;
-        array = new std::vector<JSON>(a);
+        array = new ArrayType(a.begin(), a.end());
         return *this;
     }
 
     JSON& operator=(const std::map<std::string, JSON>& obj) {
         clear();
         type = Object;
-        object = new std::map<std::string, JSON>(obj);
+        object = copyObject(obj);
+        return *this;
+    }
+
+    // The elements are moved out before clearing, for the same reason as in operator=(JSON&&).
+    JSON& operator=(std::vector<JSON>&& a) {
+        ArrayType* result = new ArrayType(std::make_move_iterator(a.begin()), std::make_move_iterator(a.end()));
+        clear();
+        type = Array;
+        array = result;
+        return *this;
+    }
+
+    JSON& operator=(std::map<std::string, JSON>&& obj) {
+        ObjectType* result = moveObject(obj);
+        clear();
+        type = Object;
+        object = result;
         return *this;
     }
 
     JSON& operator=(std::initializer_list<JSON> list) {
         clear();
         type = Array;
-        array = new std::vector<JSON>(list);
+        array = new ArrayType(list);
         return *this;
     }
 
     JSON& operator[](const std::string& key) {
+        materialize();
         if (type != Object) {
             if (type == Null) {
                 type = Object;
-                object = new std::map<std::string, JSON>();
+                object = new ObjectType();
             } else {
                 std::ostringstream oss;
                 oss << "Field \"" << key << "\" is not an object.";
@@ -150,20 +436,26 @@ public:
             }
         }
         
-        return (*object)[key];
+        // Probe with a heap key, an arena key would be left behind in the arena on every lookup.
+        ObjectType::iterator it = object->find(StringType(key.data(), key.size()));
+        if (it != object->end())
+            return it->second;
+        return (*object)[StringType(key.data(), key.size(), object->get_allocator())];
     }
 
     const JSON& operator[](const std::string& key) const {
-        if (type != Object) {
+        const JSON& self = resolved();
+        if (self.type != Object) {
             std::ostringstream oss;
             oss << "Field \"" << key << "\" is not an object.";
             throw std::runtime_error(oss.str());
         }
 
-        return object->at(key);
+        return self.object->at(StringType(key.data(), key.size()));
     }
 
     JSON& operator[](size_t index) {
+        materialize();
         if (type != Array)
             throw std::runtime_error("Trying to index a non-array JSON");
         if (index >= array->size())
@@ -172,35 +464,40 @@ public:
     }
 
     const JSON& operator[](size_t index) const {
-        if (type != Array)
+        const JSON& self = resolved();
+        if (self.type != Array)
             throw std::runtime_error("Trying to index a non-array JSON");
-        if (index >= array->size())
+        if (index >= self.array->size())
             throw std::runtime_error("Index out of range");
-        return (*array)[index];
+        return (*self.array)[index];
     }
 
-    std::vector<JSON>::iterator begin() {
+    ArrayType::iterator begin() {
+        materialize();
         if (type != Array)
             throw std::runtime_error("Value is not an array.");
         return array->begin();
     }
 
-    std::vector<JSON>::iterator end() {
+    ArrayType::iterator end() {
+        materialize();
         if (type != Array)
             throw std::runtime_error("Value is not an array.");
         return array->end();
     }
 
-    std::vector<JSON>::const_iterator begin() const {
-        if (type != Array)
+    ArrayType::const_iterator begin() const {
+        const JSON& self = resolved();
+        if (self.type != Array)
             throw std::runtime_error("JSON is not an array.");
-        return array->begin();
+        return self.array->begin();
     }
     
-    std::vector<JSON>::const_iterator end() const {
-        if (type != Array)
+    ArrayType::const_iterator end() const {
+        const JSON& self = resolved();
+        if (self.type != Array)
             throw std::runtime_error("JSON is not an array.");
-        return array->end();
+        return self.array->end();
     }
 
 #ifndef JSON_DISABLE_DUMPING
@@ -214,56 +511,193 @@ public:
 private:
     template<typename T, typename Enable>
     friend struct JSONTypeTraits;
+    friend class JSONParser;
+    friend class JSONBuilder;
 
     Type type;
+    bool borrowed = false; // String storage is not owned, it lives in an arena or an in situ buffer.
     union {
         bool boolean;
-        int integer;
+        int64_t integer;
+        uint64_t unsignedInteger;
         double doubleVal;
-        std::string* string;
-        std::vector<JSON>* array;
-        std::map<std::string, JSON>* object;
+        const JSONStringRef* ref;
+        ArrayType* array;
+        ObjectType* object;
+        JSONLazyRef* lazy;
     };
 
     void clear() {
         switch (type) {
-            case String: delete string; break;
-            case Array: delete array; break;
-            case Object: delete object; break;
+            case String: if (!borrowed) ::operator delete(const_cast<JSONStringRef*>(ref)); break;
+            case Array: release(array); break;
+            case Object: release(object); break;
+            case Lazy: delete lazy; break;
             default: break;
         }
 
         type = Null;
+        borrowed = false;
+    }
+
+    // Containers in an arena are never destroyed one by one, the arena takes their memory and everything
+    // nested inside them in one go.
+    template<typename T>
+    static void release(T* container) {
+        if (!container->get_allocator().arena)
+            delete container;
+    }
+
+    template<typename T>
+    static T* create(JSONArena* arena) {
+        if (!arena)
+            return new T();
+        return new (arena->allocate(sizeof(T), alignof(T))) T(typename T::allocator_type(arena));
+    }
+
+    static ObjectType* copyObject(const std::map<std::string, JSON>& obj) {
+        ObjectType* result = new ObjectType();
+        for (const auto& pair : obj)
+            result->insert(result->end(), std::make_pair(StringType(pair.first.data(), pair.first.size()), pair.second));
+        return result;
+    }
+
+    static ObjectType* moveObject(std::map<std::string, JSON>& obj) {
+        ObjectType* result = new ObjectType();
+        for (auto& pair : obj)
+            result->insert(result->end(), std::make_pair(StringType(pair.first.data(), pair.first.size()), std::move(pair.second)));
+        return result;
+    }
+
+    // Strings are immutable, so a single allocation holds the header and the characters.
+    static const JSONStringRef* newString(const char* data, size_t size, JSONArena* arena = nullptr) {
+        size_t bytes = sizeof(JSONStringRef) + size;
+        void* block = arena ? arena->allocate(bytes, alignof(JSONStringRef)) : ::operator new(bytes);
+        JSONStringRef* value = static_cast<JSONStringRef*>(block);
+        char* chars = reinterpret_cast<char*>(value + 1);
+        memcpy(chars, data, size);
+        value->data = chars;
+        value->size = size;
+        return value;
+    }
+
+    // Used by JSONBuilder to build values in place, in the arena when one is given.
+    void makeString(const char* data, size_t size, JSONArena* arena = nullptr) {
+        clear();
+        type = String;
+        borrowed = arena != nullptr;
+        ref = newString(data, size, arena);
+    }
+
+    // The reference lives in the arena, the characters stay where they are.
+    void makeStringRef(JSONArena* arena, const char* data, size_t size) {
+        clear();
+        JSONStringRef* value = static_cast<JSONStringRef*>(arena->allocate(sizeof(JSONStringRef), alignof(JSONStringRef)));
+        value->data = data;
+        value->size = size;
+        type = String;
+        borrowed = true;
+        ref = value;
+    }
+
+    // An existing container is only reused when it lives where the new one would, otherwise heap children would
+    // end up in an arena container that is never destroyed, or the other way round.
+    ArrayType& makeArray(JSONArena* arena = nullptr) {
+        if (type == Array && array->get_allocator().arena == arena) {
+            array->clear();
+            return *array;
+        }
+
+        clear();
+        type = Array;
+        array = create<ArrayType>(arena);
+        return *array;
+    }
+
+    ObjectType& makeObject(JSONArena* arena = nullptr) {
+        if (type == Object && object->get_allocator().arena == arena) {
+            object->clear();
+            return *object;
+        }
+
+        clear();
+        type = Object;
+        object = create<ObjectType>(arena);
+        return *object;
+    }
+
+    void makeLazy(const std::shared_ptr<const JSONLazyDocument>& document, size_t container) {
+        clear();
+        type = Lazy;
+        lazy = new JSONLazyRef(document, container);
+    }
+
+    // Turns a Lazy value into its array or object, one level deep, before it is handed out for changes.
+    void materialize() {
+        if (type == Lazy)
+            materializeLazy();
+    }
+
+    // Value const accessors read from: this one, or the container a Lazy value builds behind its reference.
+    const JSON& resolved() const {
+        return type == Lazy ? lazyValue() : *this;
+    }
+
+    // Defined after JSONParser.
+    void materializeLazy();
+    const JSON& lazyValue() const;
+
+    // Takes over the payload of other, whose type is already in this->type, and leaves other null.
+    void take(JSON& other) noexcept {
+        switch (type) {
+            case Null: break;
+            case Boolean: boolean = other.boolean; break;
+            case Double: doubleVal = other.doubleVal; break;
+            case String: ref = other.ref; break;
+            case Array: array = other.array; break;
+            case Object: object = other.object; break;
+            case Lazy: lazy = other.lazy; break;
+            default: unsignedInteger = other.unsignedInteger; break;
+        }
+        borrowed = other.borrowed;
+        other.type = Null;
+        other.borrowed = false;
     }
 
     void copy(const JSON& other) {
         switch (other.type) {
             case Boolean: boolean = other.boolean; break;
             case Integer: integer = other.integer; break;
+            case UnsignedInteger: unsignedInteger = other.unsignedInteger; break;
             case Double: doubleVal = other.doubleVal; break;
-            case String: string = new std::string(*other.string); break;
-            case Array: array = new std::vector<JSON>(*other.array); break;
-            case Object: object = new std::map<std::string, JSON>(*other.object); break;
+            case String: ref = newString(other.ref->data, other.ref->size); break;
+            case Array: array = new ArrayType(*other.array); break;
+            case Object: object = new ObjectType(*other.object); break;
+            case Lazy: lazy = new JSONLazyRef(other.lazy->document, other.lazy->container); break;
             default: break;
         }
     }
 
 #ifndef JSON_DISABLE_DUMPING
-    void dumpValue(const JSON& value, std::ostringstream& oss, int level, int indent) const {
+    void dumpValue(const JSON& json, std::ostringstream& oss, int level, int indent) const {
+        const JSON& value = json.resolved();
         switch (value.type) {
             case Null: oss << "null"; break;
             case Boolean: oss << (value.boolean ? "true" : "false"); break;
             case Integer: oss << value.integer; break;
+            case UnsignedInteger: oss << value.unsignedInteger; break;
             case Double: oss << value.doubleVal; break;
-            case String: dumpString(*value.string, oss); break;
+            case String: dumpString(value.ref->data, value.ref->size, oss); break;
             case Array: dumpArray(*value.array, oss, level, indent); break;
             case Object: dumpObject(*value.object, oss, level, indent); break;
+            default: break;
         }
     }
 
-    void dumpString(const std::string& str, std::ostringstream& oss) const {
+    void dumpString(const char* str, size_t length, std::ostringstream& oss) const {
         oss << '"';
-        for (char ch : str) {
+        for (size_t i = 0; i < length; ++i) {
+            unsigned char ch = static_cast<unsigned char>(str[i]);
             switch (ch) {
                 case '"': oss << "\\\""; break;
                 case '\\': oss << "\\\\"; break;
@@ -274,9 +708,9 @@ private:
                 case '\t': oss << "\\t"; break;
                 default:
                     if (ch < 32 || ch == 127) {
-                        oss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(ch);
+                        oss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(ch) << std::dec;
                     } else {
-                        oss << ch;
+                        oss << static_cast<char>(ch);
                     }
                     break;
             }
@@ -284,10 +718,10 @@ private:
         oss << '"';
     }
 
-    void dumpArray(const std::vector<JSON>& arr, std::ostringstream& oss, int level, int indent) const {
+    void dumpArray(const ArrayType& arr, std::ostringstream& oss, int level, int indent) const {
         bool hasComplexChildren = false;
         for (const auto& item : arr) {
-            if (item.type == JSON::Object || item.type == JSON::Array) {
+            if (item.type == JSON::Object || item.type == JSON::Array || item.type == JSON::Lazy) {
                 hasComplexChildren = true;
                 break;
             }
@@ -321,16 +755,16 @@ private:
         oss << ']';
     }
 
-    void dumpObject(const std::map<std::string, JSON>& obj, std::ostringstream& oss, int level, int indent) const {
+    void dumpObject(const ObjectType& obj, std::ostringstream& oss, int level, int indent) const {
         oss << '{';
         if (indent > 0) oss << '\n';
         size_t i = 0;
         for (const auto& pair : obj) {
-            const std::string& key = pair.first;
+            const StringType& key = pair.first;
             const JSON& value = pair.second;
 
             if (indent > 0) oss << std::string(level + indent, ' ');
-            dumpString(key, oss);
+            dumpString(key.data(), key.size(), oss);
             oss << ':';
             if (indent > 0) oss << ' ';
             dumpValue(value, oss, level + indent, indent);
@@ -355,12 +789,36 @@ struct JSONTypeTraits<bool> {
 template<>
 struct JSONTypeTraits<int> {
   static int as(const JSON& json) {
-    if (json.type != JSON::Integer)
+    if (json.type != JSON::Integer && json.type != JSON::UnsignedInteger)
+      throw std::runtime_error("Not an integer");
+    if (json.type == JSON::UnsignedInteger || json.integer < INT_MIN || json.integer > INT_MAX)
+      throw std::runtime_error("Integer out of range");
+    return static_cast<int>(json.integer);
+  }
+};
+
+template<>
+struct JSONTypeTraits<int64_t> {
+  static int64_t as(const JSON& json) {
+    if (json.type != JSON::Integer && json.type != JSON::UnsignedInteger)
       throw std::runtime_error("Not an integer");
+    if (json.type == JSON::UnsignedInteger)
+      throw std::runtime_error("Integer out of range");
     return json.integer;
   }
 };
 
+template<>
+struct JSONTypeTraits<uint64_t> {
+  static uint64_t as(const JSON& json) {
+    if (json.type != JSON::Integer && json.type != JSON::UnsignedInteger)
+      throw std::runtime_error("Not an integer");
+    if (json.type == JSON::Integer && json.integer < 0)
+      throw std::runtime_error("Integer out of range");
+    return json.unsignedInteger;
+  }
+};
+
 template<>
 struct JSONTypeTraits<double> {
   static double as(const JSON& json) {
@@ -375,7 +833,14 @@ struct JSONTypeTraits<std::string> {
   static std::string as(const JSON& json) {
     if (json.type != JSON::String)
       throw std::runtime_error("Not a string");
-    return *json.string;
+    return std::string(json.ref->data, json.ref->size);
+  }
+};
+
+template<>
+struct JSONTypeTraits<JSON> {
+  static JSON as(const JSON& json) {
+    return json;
   }
 };
 
@@ -400,7 +865,11 @@ struct JSONTypeTraits<std::map<std::string, JSON>> {
   static std::map<std::string, JSON> as(const JSON& json) {
     if (json.type != JSON::Object)
       throw std::runtime_error("Not an object");
-    return *json.object;
+
+    std::map<std::string, JSON> result;
+    for (const auto& pair : *json.object)
+      result.insert(result.end(), std::make_pair(std::string(pair.first.data(), pair.first.size()), pair.second));
+    return result;
   }
 };
 
@@ -409,195 +878,3592 @@ struct JSONTypeTraits<T, typename std::enable_if<std::is_arithmetic<T>::value>::
   static T as(const JSON& json) {
     switch (json.type) {
       case JSON::Integer: return static_cast<T>(json.integer);
+      case JSON::UnsignedInteger: return static_cast<T>(json.unsignedInteger);
       case JSON::Double: return static_cast<T>(json.doubleVal);
       default: throw std::runtime_error("Not a numeric type");
     }
   }
 };
 
-class JSONParser {
+// Read only view of a whole file. Uses mmap where available and falls back to reading the file into memory.
+class JSONMappedFile {
 public:
-    JSONParser(const std::string& data) : data(data), pos(0), line(1), col(1) {}
-    JSONParser(std::ifstream& f)
-    : data(std::string((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>())), pos(0), line(1), col(1) {}
+    enum Flags {
+        Sequential = 1, // madvise(MADV_SEQUENTIAL), lets the kernel read ahead aggressively.
+        Populate = 2    // MAP_POPULATE, prefaults the whole mapping up front (Linux only).
+    };
 
-    static JSON parse(const std::string& data) {
-        JSONParser parser(data);
-        if (parser.data.empty())
-            throw std::runtime_error("Empty JSON file");
+    explicit JSONMappedFile(const std::string& path, int flags = Sequential) : ptr(nullptr), length(0) {
+#ifdef JSON_HAS_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Could not open JSON file: " + path);
 
-        return parser.parse();
-    }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Could not stat JSON file: " + path);
+        }
 
-    static JSON parse(std::ifstream& f) {
-        JSONParser parser(f);
-        if (parser.data.empty())
-            throw std::runtime_error("Empty JSON file");
+        length = static_cast<size_t>(st.st_size);
+        if (length > 0) {
+            int mapFlags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+            if (flags & Populate)
+                mapFlags |= MAP_POPULATE;
+#endif
+            void* mapping = mmap(nullptr, length, PROT_READ, mapFlags, fd, 0);
+            if (mapping == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Could not map JSON file: " + path);
+            }
+
+            if (flags & Sequential)
+                madvise(mapping, length, MADV_SEQUENTIAL);
+
+            ptr = static_cast<const char*>(mapping);
+        }
+
+        ::close(fd);
+#else
+        (void)flags;
+        std::ifstream f(path.c_str(), std::ios::binary);
+        if (!f)
+            throw std::runtime_error("Could not open JSON file: " + path);
+
+        f.seekg(0, std::ios::end);
+        buffer.resize(static_cast<size_t>(f.tellg()));
+        f.seekg(0, std::ios::beg);
+        f.read(&buffer[0], buffer.size());
+        ptr = buffer.data();
+        length = buffer.size();
+#endif
+    }
 
-        return parser.parse();
+    ~JSONMappedFile() {
+#ifdef JSON_HAS_MMAP
+        if (ptr)
+            munmap(const_cast<char*>(ptr), length);
+#endif
     }
 
+    JSONMappedFile(const JSONMappedFile&) = delete;
+    JSONMappedFile& operator=(const JSONMappedFile&) = delete;
+
+    const char* data() const { return ptr; }
+    size_t size() const { return length; }
 
 private:
-    std::string data;
-    int pos;
-    int line;
-    int col;
+    const char* ptr;
+    size_t length;
+#ifndef JSON_HAS_MMAP
+    std::string buffer;
+#endif
+};
 
-    JSON parse() {
-        skipWhitespace();
-        return parseValue();
-    }
+// Decimal significand and exponent collected by the parser, converted to the nearest double with the
+// Clinger fast path or the Eisel-Lemire algorithm. No allocations and no locale involvement in either.
+struct JSONDecimal {
+    uint64_t mantissa;  // First 19 significant digits.
+    int64_t exponent;   // Power of ten applied to mantissa.
+    bool negative;
+    bool truncated;     // More than 19 significant digits were present.
+    const char* begin;  // Source text, only read by the rare slow path.
+    const char* end;
 
-    void advance(int count = 1) {
-        for (int i = 0; i < count; ++i) {
-            if (data[pos] == '\n') {
-                line++;
-                col = 1;
-            } else {
-                col++;
-            }
-            pos++;
+    // Returns false if the value overflows a double.
+    bool toDouble(double& out) const {
+        if (!truncated && mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+            static const double powers[] = {
+                1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+            };
+            double value = static_cast<double>(mantissa);
+            value = exponent < 0 ? value / powers[-exponent] : value * powers[exponent];
+            out = negative ? -value : value;
+            return true;
         }
-    }
 
-    void skipWhitespace() {
-        while (data[pos] && isspace(data[pos])) {
-            advance();
+        uint64_t bits = 0;
+        if (!eiselLemire(mantissa, exponent, bits))
+            return false;
+
+        // With truncated digits the exact value lies between mantissa and mantissa + 1, both must round the same way.
+        if (truncated) {
+            uint64_t upper = 0;
+            if (!eiselLemire(mantissa + 1, exponent, upper) || upper != bits)
+                return fallback(out);
         }
+
+        if (negative)
+            bits |= 1ULL << 63;
+        memcpy(&out, &bits, sizeof(out));
+        return true;
     }
 
-    [[noreturn]] void throwError(const std::string& message) const {
-        std::ostringstream oss;
+private:
+    static const int smallestPowerOfTen = -342;
+    static const int largestPowerOfTen = 308;
 
-        oss << message << " at line " << line << ", column " << col;
-        throw std::runtime_error(oss.str());
+    static void multiply(uint64_t a, uint64_t b, uint64_t& high, uint64_t& low) {
+#if defined(__SIZEOF_INT128__)
+        __extension__ typedef unsigned __int128 uint128;
+        uint128 r = static_cast<uint128>(a) * b;
+        high = static_cast<uint64_t>(r >> 64);
+        low = static_cast<uint64_t>(r);
+#else
+        uint64_t aLo = a & 0xFFFFFFFFULL, aHi = a >> 32;
+        uint64_t bLo = b & 0xFFFFFFFFULL, bHi = b >> 32;
+        uint64_t ll = aLo * bLo, lh = aLo * bHi, hl = aHi * bLo, hh = aHi * bHi;
+        uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFFULL) + (hl & 0xFFFFFFFFULL);
+        high = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+        low = (mid << 32) | (ll & 0xFFFFFFFFULL);
+#endif
     }
 
-    JSON parseValue() {
-        skipWhitespace();
-        char ch = data[pos];
-        if (ch == '{')
-            return parseObject();
-        else if (ch == '[')
-            return parseArray();
-        else if (ch == '"')
-            return parseString();
-        else if (ch == 't' || ch == 'f')
-            return parseBoolean();
-        else if (ch == 'n')
-            return parseNull();
-        else if (ch == '-' || (ch >= '0' && ch <= '9'))
-            return parseNumber();
-        else
-            throwError("Unexpected character in JSON");
+    static int leadingZeroes(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_clzll(x);
+#else
+        int n = 0;
+        while (!(x & (1ULL << 63))) { x <<= 1; ++n; }
+        return n;
+#endif
     }
 
-    JSON parseObject() {
-        advance();
-        std::map<std::string, JSON> obj;
-        skipWhitespace();
-        while (data[pos] != '}') {
-            std::string key = parseString().as<std::string>();
-            skipWhitespace();
-            if (data[pos] != ':') {
-                throwError("Expected ':' in JSON object");
-            }
-            advance();
-            JSON value = parseValue();
-            obj[key] = value;
-            skipWhitespace();
-            if (data[pos] == ',') {
-                advance();
-                skipWhitespace();
-            }
+    // Computes the IEEE-754 bits (without sign) of w * 10^q rounded to nearest, ties to even.
+    static bool eiselLemire(uint64_t w, int64_t q, uint64_t& bits) {
+        const int mantissaBits = 52;
+        const int minimumExponent = -1023;
+        const int infinitePower = 0x7FF;
+
+        if (w == 0 || q < smallestPowerOfTen) {
+            bits = 0;
+            return true;
         }
-        advance();
-        return JSON(obj);
-    }
+        if (q > largestPowerOfTen)
+            return false;
 
-    JSON parseArray() {
-        advance();
-        std::vector<JSON> arr;
-        skipWhitespace();
-        while (data[pos] != ']') {
-            arr.push_back(parseValue());
-            skipWhitespace();
-            if (data[pos] == ',') {
-                advance();
-                skipWhitespace();
-            }
+        int lz = leadingZeroes(w);
+        w <<= lz;
+
+        const uint64_t* powers = powersOfFive();
+        size_t index = 2 * static_cast<size_t>(q - smallestPowerOfTen);
+        uint64_t high, low;
+        multiply(w, powers[index], high, low);
+        const uint64_t precisionMask = 0xFFFFFFFFFFFFFFFFULL >> (mantissaBits + 3);
+        if ((high & precisionMask) == precisionMask) {
+            uint64_t secondHigh, secondLow;
+            multiply(w, powers[index + 1], secondHigh, secondLow);
+            low += secondHigh;
+            if (secondHigh > low)
+                high++;
         }
-        advance();
-        return JSON(arr);
-    }
 
-    JSON parseString() {
-        advance();
-        std::string str;
-        while (data[pos] != '"') {
-            if (data[pos] == '\\') {
-                advance();
-                switch (data[pos]) {
-                    case '\\': str += '\\'; break;
-                    case '"': str += '"'; break;
-                    case '/': str += '/'; break;
-                    case 'b': str += '\b'; break;
-                    case 'f': str += '\f'; break;
-                    case 'n': str += '\n'; break;
-                    case 'r': str += '\r'; break;
-                    case 't': str += '\t'; break;
-                    default: throwError("Invalid escape character in string");
-                }
-                advance();
-            } else {
-                str += data[pos];
-                advance();
+        int upperBit = static_cast<int>(high >> 63);
+        int shift = upperBit + 64 - mantissaBits - 3;
+        uint64_t mantissa = high >> shift;
+        int64_t power2 = (((152170 + 65536) * q) >> 16) + 63 + upperBit - lz - minimumExponent;
+
+        if (power2 <= 0) {
+            if (-power2 + 1 >= 64) {
+                bits = 0;
+                return true;
             }
+            mantissa >>= -power2 + 1;
+            mantissa += mantissa & 1;
+            mantissa >>= 1;
+            power2 = mantissa < (1ULL << mantissaBits) ? 0 : 1;
+            bits = (mantissa & ~(1ULL << mantissaBits)) | (static_cast<uint64_t>(power2) << mantissaBits);
+            return true;
         }
-        advance();
-        return JSON(str);
-    }
 
-    JSON parseBoolean() {
-        if (strncmp(&data[pos], "true", 4) == 0) {
-            advance(4);
-            return JSON(true);
-        } else if (strncmp(&data[pos], "false", 5) == 0) {
-            advance(5);
-            return JSON(false);
-        } else {
-            throwError("Unexpected boolean value in JSON");
+        // Exactly halfway between two doubles: round to even instead of up.
+        if (low <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 && (mantissa << shift) == high)
+            mantissa &= ~1ULL;
+
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        if (mantissa >= (2ULL << mantissaBits)) {
+            mantissa = 1ULL << mantissaBits;
+            power2++;
         }
+        mantissa &= ~(1ULL << mantissaBits);
+        if (power2 >= infinitePower)
+            return false;
+
+        bits = mantissa | (static_cast<uint64_t>(power2) << mantissaBits);
+        return true;
     }
 
-    JSON parseNull() {
-        if (strncmp(&data[pos], "null", 4) == 0) {
-            advance(4);
-            return JSON();
-        } else {
-            throwError("Unexpected null value in JSON");
+    // Rare case of more than 19 digits sitting right on a rounding boundary, strtod settles it from the source text.
+    bool fallback(double& out) const {
+        std::string text(begin, end);
+        const char* point = localeconv()->decimal_point;
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (text[i] == '.')
+                text[i] = point[0];
         }
+
+        errno = 0;
+        out = strtod(text.c_str(), nullptr);
+        return errno != ERANGE || std::fabs(out) < 1.0;
     }
 
-    JSON parseNumber() {
-        size_t start = pos;
-        if (data[pos] == '-') {
-            advance();
-        }
-        while (data[pos] >= '0' && data[pos] <= '9') {
+    // 128-bit truncated powers of five from 5^-342 to 5^308, high word first.
+    static const uint64_t* powersOfFive() {
+        static const uint64_t table[] = {
+            0xeef453d6923bd65aULL, 0x113faa2906a13b3fULL, 0x9558b4661b6565f8ULL, 0x4ac7ca59a424c507ULL,
+            0xbaaee17fa23ebf76ULL, 0x5d79bcf00d2df649ULL, 0xe95a99df8ace6f53ULL, 0xf4d82c2c107973dcULL,
+            0x91d8a02bb6c10594ULL, 0x79071b9b8a4be869ULL, 0xb64ec836a47146f9ULL, 0x9748e2826cdee284ULL,
+            0xe3e27a444d8d98b7ULL, 0xfd1b1b2308169b25ULL, 0x8e6d8c6ab0787f72ULL, 0xfe30f0f5e50e20f7ULL,
+            0xb208ef855c969f4fULL, 0xbdbd2d335e51a935ULL, 0xde8b2b66b3bc4723ULL, 0xad2c788035e61382ULL,
+            0x8b16fb203055ac76ULL, 0x4c3bcb5021afcc31ULL, 0xaddcb9e83c6b1793ULL, 0xdf4abe242a1bbf3dULL,
+            0xd953e8624b85dd78ULL, 0xd71d6dad34a2af0dULL, 0x87d4713d6f33aa6bULL, 0x8672648c40e5ad68ULL,
+            0xa9c98d8ccb009506ULL, 0x680efdaf511f18c2ULL, 0xd43bf0effdc0ba48ULL, 0x0212bd1b2566def2ULL,
+            0x84a57695fe98746dULL, 0x014bb630f7604b57ULL, 0xa5ced43b7e3e9188ULL, 0x419ea3bd35385e2dULL,
+            0xcf42894a5dce35eaULL, 0x52064cac828675b9ULL, 0x818995ce7aa0e1b2ULL, 0x7343efebd1940993ULL,
+            0xa1ebfb4219491a1fULL, 0x1014ebe6c5f90bf8ULL, 0xca66fa129f9b60a6ULL, 0xd41a26e077774ef6ULL,
+            0xfd00b897478238d0ULL, 0x8920b098955522b4ULL, 0x9e20735e8cb16382ULL, 0x55b46e5f5d5535b0ULL,
+            0xc5a890362fddbc62ULL, 0xeb2189f734aa831dULL, 0xf712b443bbd52b7bULL, 0xa5e9ec7501d523e4ULL,
+            0x9a6bb0aa55653b2dULL, 0x47b233c92125366eULL, 0xc1069cd4eabe89f8ULL, 0x999ec0bb696e840aULL,
+            0xf148440a256e2c76ULL, 0xc00670ea43ca250dULL, 0x96cd2a865764dbcaULL, 0x380406926a5e5728ULL,
+            0xbc807527ed3e12bcULL, 0xc605083704f5ecf2ULL, 0xeba09271e88d976bULL, 0xf7864a44c633682eULL,
+            0x93445b8731587ea3ULL, 0x7ab3ee6afbe0211dULL, 0xb8157268fdae9e4cULL, 0x5960ea05bad82964ULL,
+            0xe61acf033d1a45dfULL, 0x6fb92487298e33bdULL, 0x8fd0c16206306babULL, 0xa5d3b6d479f8e056ULL,
+            0xb3c4f1ba87bc8696ULL, 0x8f48a4899877186cULL, 0xe0b62e2929aba83cULL, 0x331acdabfe94de87ULL,
+            0x8c71dcd9ba0b4925ULL, 0x9ff0c08b7f1d0b14ULL, 0xaf8e5410288e1b6fULL, 0x07ecf0ae5ee44dd9ULL,
+            0xdb71e91432b1a24aULL, 0xc9e82cd9f69d6150ULL, 0x892731ac9faf056eULL, 0xbe311c083a225cd2ULL,
+            0xab70fe17c79ac6caULL, 0x6dbd630a48aaf406ULL, 0xd64d3d9db981787dULL, 0x092cbbccdad5b108ULL,
+            0x85f0468293f0eb4eULL, 0x25bbf56008c58ea5ULL, 0xa76c582338ed2621ULL, 0xaf2af2b80af6f24eULL,
+            0xd1476e2c07286faaULL, 0x1af5af660db4aee1ULL, 0x82cca4db847945caULL, 0x50d98d9fc890ed4dULL,
+            0xa37fce126597973cULL, 0xe50ff107bab528a0ULL, 0xcc5fc196fefd7d0cULL, 0x1e53ed49a96272c8ULL,
+            0xff77b1fcbebcdc4fULL, 0x25e8e89c13bb0f7aULL, 0x9faacf3df73609b1ULL, 0x77b191618c54e9acULL,
+            0xc795830d75038c1dULL, 0xd59df5b9ef6a2417ULL, 0xf97ae3d0d2446f25ULL, 0x4b0573286b44ad1dULL,
+            0x9becce62836ac577ULL, 0x4ee367f9430aec32ULL, 0xc2e801fb244576d5ULL, 0x229c41f793cda73fULL,
+            0xf3a20279ed56d48aULL, 0x6b43527578c1110fULL, 0x9845418c345644d6ULL, 0x830a13896b78aaa9ULL,
+            0xbe5691ef416bd60cULL, 0x23cc986bc656d553ULL, 0xedec366b11c6cb8fULL, 0x2cbfbe86b7ec8aa8ULL,
+            0x94b3a202eb1c3f39ULL, 0x7bf7d71432f3d6a9ULL, 0xb9e08a83a5e34f07ULL, 0xdaf5ccd93fb0cc53ULL,
+            0xe858ad248f5c22c9ULL, 0xd1b3400f8f9cff68ULL, 0x91376c36d99995beULL, 0x23100809b9c21fa1ULL,
+            0xb58547448ffffb2dULL, 0xabd40a0c2832a78aULL, 0xe2e69915b3fff9f9ULL, 0x16c90c8f323f516cULL,
+            0x8dd01fad907ffc3bULL, 0xae3da7d97f6792e3ULL, 0xb1442798f49ffb4aULL, 0x99cd11cfdf41779cULL,
+            0xdd95317f31c7fa1dULL, 0x40405643d711d583ULL, 0x8a7d3eef7f1cfc52ULL, 0x482835ea666b2572ULL,
+            0xad1c8eab5ee43b66ULL, 0xda3243650005eecfULL, 0xd863b256369d4a40ULL, 0x90bed43e40076a82ULL,
+            0x873e4f75e2224e68ULL, 0x5a7744a6e804a291ULL, 0xa90de3535aaae202ULL, 0x711515d0a205cb36ULL,
+            0xd3515c2831559a83ULL, 0x0d5a5b44ca873e03ULL, 0x8412d9991ed58091ULL, 0xe858790afe9486c2ULL,
+            0xa5178fff668ae0b6ULL, 0x626e974dbe39a872ULL, 0xce5d73ff402d98e3ULL, 0xfb0a3d212dc8128fULL,
+            0x80fa687f881c7f8eULL, 0x7ce66634bc9d0b99ULL, 0xa139029f6a239f72ULL, 0x1c1fffc1ebc44e80ULL,
+            0xc987434744ac874eULL, 0xa327ffb266b56220ULL, 0xfbe9141915d7a922ULL, 0x4bf1ff9f0062baa8ULL,
+            0x9d71ac8fada6c9b5ULL, 0x6f773fc3603db4a9ULL, 0xc4ce17b399107c22ULL, 0xcb550fb4384d21d3ULL,
+            0xf6019da07f549b2bULL, 0x7e2a53a146606a48ULL, 0x99c102844f94e0fbULL, 0x2eda7444cbfc426dULL,
+            0xc0314325637a1939ULL, 0xfa911155fefb5308ULL, 0xf03d93eebc589f88ULL, 0x793555ab7eba27caULL,
+            0x96267c7535b763b5ULL, 0x4bc1558b2f3458deULL, 0xbbb01b9283253ca2ULL, 0x9eb1aaedfb016f16ULL,
+            0xea9c227723ee8bcbULL, 0x465e15a979c1cadcULL, 0x92a1958a7675175fULL, 0x0bfacd89ec191ec9ULL,
+            0xb749faed14125d36ULL, 0xcef980ec671f667bULL, 0xe51c79a85916f484ULL, 0x82b7e12780e7401aULL,
+            0x8f31cc0937ae58d2ULL, 0xd1b2ecb8b0908810ULL, 0xb2fe3f0b8599ef07ULL, 0x861fa7e6dcb4aa15ULL,
+            0xdfbdcece67006ac9ULL, 0x67a791e093e1d49aULL, 0x8bd6a141006042bdULL, 0xe0c8bb2c5c6d24e0ULL,
+            0xaecc49914078536dULL, 0x58fae9f773886e18ULL, 0xda7f5bf590966848ULL, 0xaf39a475506a899eULL,
+            0x888f99797a5e012dULL, 0x6d8406c952429603ULL, 0xaab37fd7d8f58178ULL, 0xc8e5087ba6d33b83ULL,
+            0xd5605fcdcf32e1d6ULL, 0xfb1e4a9a90880a64ULL, 0x855c3be0a17fcd26ULL, 0x5cf2eea09a55067fULL,
+            0xa6b34ad8c9dfc06fULL, 0xf42faa48c0ea481eULL, 0xd0601d8efc57b08bULL, 0xf13b94daf124da26ULL,
+            0x823c12795db6ce57ULL, 0x76c53d08d6b70858ULL, 0xa2cb1717b52481edULL, 0x54768c4b0c64ca6eULL,
+            0xcb7ddcdda26da268ULL, 0xa9942f5dcf7dfd09ULL, 0xfe5d54150b090b02ULL, 0xd3f93b35435d7c4cULL,
+            0x9efa548d26e5a6e1ULL, 0xc47bc5014a1a6dafULL, 0xc6b8e9b0709f109aULL, 0x359ab6419ca1091bULL,
+            0xf867241c8cc6d4c0ULL, 0xc30163d203c94b62ULL, 0x9b407691d7fc44f8ULL, 0x79e0de63425dcf1dULL,
+            0xc21094364dfb5636ULL, 0x985915fc12f542e4ULL, 0xf294b943e17a2bc4ULL, 0x3e6f5b7b17b2939dULL,
+            0x979cf3ca6cec5b5aULL, 0xa705992ceecf9c42ULL, 0xbd8430bd08277231ULL, 0x50c6ff782a838353ULL,
+            0xece53cec4a314ebdULL, 0xa4f8bf5635246428ULL, 0x940f4613ae5ed136ULL, 0x871b7795e136be99ULL,
+            0xb913179899f68584ULL, 0x28e2557b59846e3fULL, 0xe757dd7ec07426e5ULL, 0x331aeada2fe589cfULL,
+            0x9096ea6f3848984fULL, 0x3ff0d2c85def7621ULL, 0xb4bca50b065abe63ULL, 0x0fed077a756b53a9ULL,
+            0xe1ebce4dc7f16dfbULL, 0xd3e8495912c62894ULL, 0x8d3360f09cf6e4bdULL, 0x64712dd7abbbd95cULL,
+            0xb080392cc4349decULL, 0xbd8d794d96aacfb3ULL, 0xdca04777f541c567ULL, 0xecf0d7a0fc5583a0ULL,
+            0x89e42caaf9491b60ULL, 0xf41686c49db57244ULL, 0xac5d37d5b79b6239ULL, 0x311c2875c522ced5ULL,
+            0xd77485cb25823ac7ULL, 0x7d633293366b828bULL, 0x86a8d39ef77164bcULL, 0xae5dff9c02033197ULL,
+            0xa8530886b54dbdebULL, 0xd9f57f830283fdfcULL, 0xd267caa862a12d66ULL, 0xd072df63c324fd7bULL,
+            0x8380dea93da4bc60ULL, 0x4247cb9e59f71e6dULL, 0xa46116538d0deb78ULL, 0x52d9be85f074e608ULL,
+            0xcd795be870516656ULL, 0x67902e276c921f8bULL, 0x806bd9714632dff6ULL, 0x00ba1cd8a3db53b6ULL,
+            0xa086cfcd97bf97f3ULL, 0x80e8a40eccd228a4ULL, 0xc8a883c0fdaf7df0ULL, 0x6122cd128006b2cdULL,
+            0xfad2a4b13d1b5d6cULL, 0x796b805720085f81ULL, 0x9cc3a6eec6311a63ULL, 0xcbe3303674053bb0ULL,
+            0xc3f490aa77bd60fcULL, 0xbedbfc4411068a9cULL, 0xf4f1b4d515acb93bULL, 0xee92fb5515482d44ULL,
+            0x991711052d8bf3c5ULL, 0x751bdd152d4d1c4aULL, 0xbf5cd54678eef0b6ULL, 0xd262d45a78a0635dULL,
+            0xef340a98172aace4ULL, 0x86fb897116c87c34ULL, 0x9580869f0e7aac0eULL, 0xd45d35e6ae3d4da0ULL,
+            0xbae0a846d2195712ULL, 0x8974836059cca109ULL, 0xe998d258869facd7ULL, 0x2bd1a438703fc94bULL,
+            0x91ff83775423cc06ULL, 0x7b6306a34627ddcfULL, 0xb67f6455292cbf08ULL, 0x1a3bc84c17b1d542ULL,
+            0xe41f3d6a7377eecaULL, 0x20caba5f1d9e4a93ULL, 0x8e938662882af53eULL, 0x547eb47b7282ee9cULL,
+            0xb23867fb2a35b28dULL, 0xe99e619a4f23aa43ULL, 0xdec681f9f4c31f31ULL, 0x6405fa00e2ec94d4ULL,
+            0x8b3c113c38f9f37eULL, 0xde83bc408dd3dd04ULL, 0xae0b158b4738705eULL, 0x9624ab50b148d445ULL,
+            0xd98ddaee19068c76ULL, 0x3badd624dd9b0957ULL, 0x87f8a8d4cfa417c9ULL, 0xe54ca5d70a80e5d6ULL,
+            0xa9f6d30a038d1dbcULL, 0x5e9fcf4ccd211f4cULL, 0xd47487cc8470652bULL, 0x7647c3200069671fULL,
+            0x84c8d4dfd2c63f3bULL, 0x29ecd9f40041e073ULL, 0xa5fb0a17c777cf09ULL, 0xf468107100525890ULL,
+            0xcf79cc9db955c2ccULL, 0x7182148d4066eeb4ULL, 0x81ac1fe293d599bfULL, 0xc6f14cd848405530ULL,
+            0xa21727db38cb002fULL, 0xb8ada00e5a506a7cULL, 0xca9cf1d206fdc03bULL, 0xa6d90811f0e4851cULL,
+            0xfd442e4688bd304aULL, 0x908f4a166d1da663ULL, 0x9e4a9cec15763e2eULL, 0x9a598e4e043287feULL,
+            0xc5dd44271ad3cdbaULL, 0x40eff1e1853f29fdULL, 0xf7549530e188c128ULL, 0xd12bee59e68ef47cULL,
+            0x9a94dd3e8cf578b9ULL, 0x82bb74f8301958ceULL, 0xc13a148e3032d6e7ULL, 0xe36a52363c1faf01ULL,
+            0xf18899b1bc3f8ca1ULL, 0xdc44e6c3cb279ac1ULL, 0x96f5600f15a7b7e5ULL, 0x29ab103a5ef8c0b9ULL,
+            0xbcb2b812db11a5deULL, 0x7415d448f6b6f0e7ULL, 0xebdf661791d60f56ULL, 0x111b495b3464ad21ULL,
+            0x936b9fcebb25c995ULL, 0xcab10dd900beec34ULL, 0xb84687c269ef3bfbULL, 0x3d5d514f40eea742ULL,
+            0xe65829b3046b0afaULL, 0x0cb4a5a3112a5112ULL, 0x8ff71a0fe2c2e6dcULL, 0x47f0e785eaba72abULL,
+            0xb3f4e093db73a093ULL, 0x59ed216765690f56ULL, 0xe0f218b8d25088b8ULL, 0x306869c13ec3532cULL,
+            0x8c974f7383725573ULL, 0x1e414218c73a13fbULL, 0xafbd2350644eeacfULL, 0xe5d1929ef90898faULL,
+            0xdbac6c247d62a583ULL, 0xdf45f746b74abf39ULL, 0x894bc396ce5da772ULL, 0x6b8bba8c328eb783ULL,
+            0xab9eb47c81f5114fULL, 0x066ea92f3f326564ULL, 0xd686619ba27255a2ULL, 0xc80a537b0efefebdULL,
+            0x8613fd0145877585ULL, 0xbd06742ce95f5f36ULL, 0xa798fc4196e952e7ULL, 0x2c48113823b73704ULL,
+            0xd17f3b51fca3a7a0ULL, 0xf75a15862ca504c5ULL, 0x82ef85133de648c4ULL, 0x9a984d73dbe722fbULL,
+            0xa3ab66580d5fdaf5ULL, 0xc13e60d0d2e0ebbaULL, 0xcc963fee10b7d1b3ULL, 0x318df905079926a8ULL,
+            0xffbbcfe994e5c61fULL, 0xfdf17746497f7052ULL, 0x9fd561f1fd0f9bd3ULL, 0xfeb6ea8bedefa633ULL,
+            0xc7caba6e7c5382c8ULL, 0xfe64a52ee96b8fc0ULL, 0xf9bd690a1b68637bULL, 0x3dfdce7aa3c673b0ULL,
+            0x9c1661a651213e2dULL, 0x06bea10ca65c084eULL, 0xc31bfa0fe5698db8ULL, 0x486e494fcff30a62ULL,
+            0xf3e2f893dec3f126ULL, 0x5a89dba3c3efccfaULL, 0x986ddb5c6b3a76b7ULL, 0xf89629465a75e01cULL,
+            0xbe89523386091465ULL, 0xf6bbb397f1135823ULL, 0xee2ba6c0678b597fULL, 0x746aa07ded582e2cULL,
+            0x94db483840b717efULL, 0xa8c2a44eb4571cdcULL, 0xba121a4650e4ddebULL, 0x92f34d62616ce413ULL,
+            0xe896a0d7e51e1566ULL, 0x77b020baf9c81d17ULL, 0x915e2486ef32cd60ULL, 0x0ace1474dc1d122eULL,
+            0xb5b5ada8aaff80b8ULL, 0x0d819992132456baULL, 0xe3231912d5bf60e6ULL, 0x10e1fff697ed6c69ULL,
+            0x8df5efabc5979c8fULL, 0xca8d3ffa1ef463c1ULL, 0xb1736b96b6fd83b3ULL, 0xbd308ff8a6b17cb2ULL,
+            0xddd0467c64bce4a0ULL, 0xac7cb3f6d05ddbdeULL, 0x8aa22c0dbef60ee4ULL, 0x6bcdf07a423aa96bULL,
+            0xad4ab7112eb3929dULL, 0x86c16c98d2c953c6ULL, 0xd89d64d57a607744ULL, 0xe871c7bf077ba8b7ULL,
+            0x87625f056c7c4a8bULL, 0x11471cd764ad4972ULL, 0xa93af6c6c79b5d2dULL, 0xd598e40d3dd89bcfULL,
+            0xd389b47879823479ULL, 0x4aff1d108d4ec2c3ULL, 0x843610cb4bf160cbULL, 0xcedf722a585139baULL,
+            0xa54394fe1eedb8feULL, 0xc2974eb4ee658828ULL, 0xce947a3da6a9273eULL, 0x733d226229feea32ULL,
+            0x811ccc668829b887ULL, 0x0806357d5a3f525fULL, 0xa163ff802a3426a8ULL, 0xca07c2dcb0cf26f7ULL,
+            0xc9bcff6034c13052ULL, 0xfc89b393dd02f0b5ULL, 0xfc2c3f3841f17c67ULL, 0xbbac2078d443ace2ULL,
+            0x9d9ba7832936edc0ULL, 0xd54b944b84aa4c0dULL, 0xc5029163f384a931ULL, 0x0a9e795e65d4df11ULL,
+            0xf64335bcf065d37dULL, 0x4d4617b5ff4a16d5ULL, 0x99ea0196163fa42eULL, 0x504bced1bf8e4e45ULL,
+            0xc06481fb9bcf8d39ULL, 0xe45ec2862f71e1d6ULL, 0xf07da27a82c37088ULL, 0x5d767327bb4e5a4cULL,
+            0x964e858c91ba2655ULL, 0x3a6a07f8d510f86fULL, 0xbbe226efb628afeaULL, 0x890489f70a55368bULL,
+            0xeadab0aba3b2dbe5ULL, 0x2b45ac74ccea842eULL, 0x92c8ae6b464fc96fULL, 0x3b0b8bc90012929dULL,
+            0xb77ada0617e3bbcbULL, 0x09ce6ebb40173744ULL, 0xe55990879ddcaabdULL, 0xcc420a6a101d0515ULL,
+            0x8f57fa54c2a9eab6ULL, 0x9fa946824a12232dULL, 0xb32df8e9f3546564ULL, 0x47939822dc96abf9ULL,
+            0xdff9772470297ebdULL, 0x59787e2b93bc56f7ULL, 0x8bfbea76c619ef36ULL, 0x57eb4edb3c55b65aULL,
+            0xaefae51477a06b03ULL, 0xede622920b6b23f1ULL, 0xdab99e59958885c4ULL, 0xe95fab368e45ecedULL,
+            0x88b402f7fd75539bULL, 0x11dbcb0218ebb414ULL, 0xaae103b5fcd2a881ULL, 0xd652bdc29f26a119ULL,
+            0xd59944a37c0752a2ULL, 0x4be76d3346f0495fULL, 0x857fcae62d8493a5ULL, 0x6f70a4400c562ddbULL,
+            0xa6dfbd9fb8e5b88eULL, 0xcb4ccd500f6bb952ULL, 0xd097ad07a71f26b2ULL, 0x7e2000a41346a7a7ULL,
+            0x825ecc24c873782fULL, 0x8ed400668c0c28c8ULL, 0xa2f67f2dfa90563bULL, 0x728900802f0f32faULL,
+            0xcbb41ef979346bcaULL, 0x4f2b40a03ad2ffb9ULL, 0xfea126b7d78186bcULL, 0xe2f610c84987bfa8ULL,
+            0x9f24b832e6b0f436ULL, 0x0dd9ca7d2df4d7c9ULL, 0xc6ede63fa05d3143ULL, 0x91503d1c79720dbbULL,
+            0xf8a95fcf88747d94ULL, 0x75a44c6397ce912aULL, 0x9b69dbe1b548ce7cULL, 0xc986afbe3ee11abaULL,
+            0xc24452da229b021bULL, 0xfbe85badce996168ULL, 0xf2d56790ab41c2a2ULL, 0xfae27299423fb9c3ULL,
+            0x97c560ba6b0919a5ULL, 0xdccd879fc967d41aULL, 0xbdb6b8e905cb600fULL, 0x5400e987bbc1c920ULL,
+            0xed246723473e3813ULL, 0x290123e9aab23b68ULL, 0x9436c0760c86e30bULL, 0xf9a0b6720aaf6521ULL,
+            0xb94470938fa89bceULL, 0xf808e40e8d5b3e69ULL, 0xe7958cb87392c2c2ULL, 0xb60b1d1230b20e04ULL,
+            0x90bd77f3483bb9b9ULL, 0xb1c6f22b5e6f48c2ULL, 0xb4ecd5f01a4aa828ULL, 0x1e38aeb6360b1af3ULL,
+            0xe2280b6c20dd5232ULL, 0x25c6da63c38de1b0ULL, 0x8d590723948a535fULL, 0x579c487e5a38ad0eULL,
+            0xb0af48ec79ace837ULL, 0x2d835a9df0c6d851ULL, 0xdcdb1b2798182244ULL, 0xf8e431456cf88e65ULL,
+            0x8a08f0f8bf0f156bULL, 0x1b8e9ecb641b58ffULL, 0xac8b2d36eed2dac5ULL, 0xe272467e3d222f3fULL,
+            0xd7adf884aa879177ULL, 0x5b0ed81dcc6abb0fULL, 0x86ccbb52ea94baeaULL, 0x98e947129fc2b4e9ULL,
+            0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL, 0xd29fe4b18e88640eULL, 0x8eec7f0d19a03aadULL,
+            0x83a3eeeef9153e89ULL, 0x1953cf68300424acULL, 0xa48ceaaab75a8e2bULL, 0x5fa8c3423c052dd7ULL,
+            0xcdb02555653131b6ULL, 0x3792f412cb06794dULL, 0x808e17555f3ebf11ULL, 0xe2bbd88bbee40bd0ULL,
+            0xa0b19d2ab70e6ed6ULL, 0x5b6aceaeae9d0ec4ULL, 0xc8de047564d20a8bULL, 0xf245825a5a445275ULL,
+            0xfb158592be068d2eULL, 0xeed6e2f0f0d56712ULL, 0x9ced737bb6c4183dULL, 0x55464dd69685606bULL,
+            0xc428d05aa4751e4cULL, 0xaa97e14c3c26b886ULL, 0xf53304714d9265dfULL, 0xd53dd99f4b3066a8ULL,
+            0x993fe2c6d07b7fabULL, 0xe546a8038efe4029ULL, 0xbf8fdb78849a5f96ULL, 0xde98520472bdd033ULL,
+            0xef73d256a5c0f77cULL, 0x963e66858f6d4440ULL, 0x95a8637627989aadULL, 0xdde7001379a44aa8ULL,
+            0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL, 0xe9d71b689dde71afULL, 0xaab8f01e6e10b4a6ULL,
+            0x9226712162ab070dULL, 0xcab3961304ca70e8ULL, 0xb6b00d69bb55c8d1ULL, 0x3d607b97c5fd0d22ULL,
+            0xe45c10c42a2b3b05ULL, 0x8cb89a7db77c506aULL, 0x8eb98a7a9a5b04e3ULL, 0x77f3608e92adb242ULL,
+            0xb267ed1940f1c61cULL, 0x55f038b237591ed3ULL, 0xdf01e85f912e37a3ULL, 0x6b6c46dec52f6688ULL,
+            0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL, 0xae397d8aa96c1b77ULL, 0xabec975e0a0d081aULL,
+            0xd9c7dced53c72255ULL, 0x96e7bd358c904a21ULL, 0x881cea14545c7575ULL, 0x7e50d64177da2e54ULL,
+            0xaa242499697392d2ULL, 0xdde50bd1d5d0b9e9ULL, 0xd4ad2dbfc3d07787ULL, 0x955e4ec64b44e864ULL,
+            0x84ec3c97da624ab4ULL, 0xbd5af13bef0b113eULL, 0xa6274bbdd0fadd61ULL, 0xecb1ad8aeacdd58eULL,
+            0xcfb11ead453994baULL, 0x67de18eda5814af2ULL, 0x81ceb32c4b43fcf4ULL, 0x80eacf948770ced7ULL,
+            0xa2425ff75e14fc31ULL, 0xa1258379a94d028dULL, 0xcad2f7f5359a3b3eULL, 0x096ee45813a04330ULL,
+            0xfd87b5f28300ca0dULL, 0x8bca9d6e188853fcULL, 0x9e74d1b791e07e48ULL, 0x775ea264cf55347eULL,
+            0xc612062576589ddaULL, 0x95364afe032a819eULL, 0xf79687aed3eec551ULL, 0x3a83ddbd83f52205ULL,
+            0x9abe14cd44753b52ULL, 0xc4926a9672793543ULL, 0xc16d9a0095928a27ULL, 0x75b7053c0f178294ULL,
+            0xf1c90080baf72cb1ULL, 0x5324c68b12dd6339ULL, 0x971da05074da7beeULL, 0xd3f6fc16ebca5e04ULL,
+            0xbce5086492111aeaULL, 0x88f4bb1ca6bcf585ULL, 0xec1e4a7db69561a5ULL, 0x2b31e9e3d06c32e6ULL,
+            0x9392ee8e921d5d07ULL, 0x3aff322e62439fd0ULL, 0xb877aa3236a4b449ULL, 0x09befeb9fad487c3ULL,
+            0xe69594bec44de15bULL, 0x4c2ebe687989a9b4ULL, 0x901d7cf73ab0acd9ULL, 0x0f9d37014bf60a11ULL,
+            0xb424dc35095cd80fULL, 0x538484c19ef38c95ULL, 0xe12e13424bb40e13ULL, 0x2865a5f206b06fbaULL,
+            0x8cbccc096f5088cbULL, 0xf93f87b7442e45d4ULL, 0xafebff0bcb24aafeULL, 0xf78f69a51539d749ULL,
+            0xdbe6fecebdedd5beULL, 0xb573440e5a884d1cULL, 0x89705f4136b4a597ULL, 0x31680a88f8953031ULL,
+            0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3eULL, 0xd6bf94d5e57a42bcULL, 0x3d32907604691b4dULL,
+            0x8637bd05af6c69b5ULL, 0xa63f9a49c2c1b110ULL, 0xa7c5ac471b478423ULL, 0x0fcf80dc33721d54ULL,
+            0xd1b71758e219652bULL, 0xd3c36113404ea4a9ULL, 0x83126e978d4fdf3bULL, 0x645a1cac083126eaULL,
+            0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a4ULL, 0xccccccccccccccccULL, 0xcccccccccccccccdULL,
+            0x8000000000000000ULL, 0x0000000000000000ULL, 0xa000000000000000ULL, 0x0000000000000000ULL,
+            0xc800000000000000ULL, 0x0000000000000000ULL, 0xfa00000000000000ULL, 0x0000000000000000ULL,
+            0x9c40000000000000ULL, 0x0000000000000000ULL, 0xc350000000000000ULL, 0x0000000000000000ULL,
+            0xf424000000000000ULL, 0x0000000000000000ULL, 0x9896800000000000ULL, 0x0000000000000000ULL,
+            0xbebc200000000000ULL, 0x0000000000000000ULL, 0xee6b280000000000ULL, 0x0000000000000000ULL,
+            0x9502f90000000000ULL, 0x0000000000000000ULL, 0xba43b74000000000ULL, 0x0000000000000000ULL,
+            0xe8d4a51000000000ULL, 0x0000000000000000ULL, 0x9184e72a00000000ULL, 0x0000000000000000ULL,
+            0xb5e620f480000000ULL, 0x0000000000000000ULL, 0xe35fa931a0000000ULL, 0x0000000000000000ULL,
+            0x8e1bc9bf04000000ULL, 0x0000000000000000ULL, 0xb1a2bc2ec5000000ULL, 0x0000000000000000ULL,
+            0xde0b6b3a76400000ULL, 0x0000000000000000ULL, 0x8ac7230489e80000ULL, 0x0000000000000000ULL,
+            0xad78ebc5ac620000ULL, 0x0000000000000000ULL, 0xd8d726b7177a8000ULL, 0x0000000000000000ULL,
+            0x878678326eac9000ULL, 0x0000000000000000ULL, 0xa968163f0a57b400ULL, 0x0000000000000000ULL,
+            0xd3c21bcecceda100ULL, 0x0000000000000000ULL, 0x84595161401484a0ULL, 0x0000000000000000ULL,
+            0xa56fa5b99019a5c8ULL, 0x0000000000000000ULL, 0xcecb8f27f4200f3aULL, 0x0000000000000000ULL,
+            0x813f3978f8940984ULL, 0x4000000000000000ULL, 0xa18f07d736b90be5ULL, 0x5000000000000000ULL,
+            0xc9f2c9cd04674edeULL, 0xa400000000000000ULL, 0xfc6f7c4045812296ULL, 0x4d00000000000000ULL,
+            0x9dc5ada82b70b59dULL, 0xf020000000000000ULL, 0xc5371912364ce305ULL, 0x6c28000000000000ULL,
+            0xf684df56c3e01bc6ULL, 0xc732000000000000ULL, 0x9a130b963a6c115cULL, 0x3c7f400000000000ULL,
+            0xc097ce7bc90715b3ULL, 0x4b9f100000000000ULL, 0xf0bdc21abb48db20ULL, 0x1e86d40000000000ULL,
+            0x96769950b50d88f4ULL, 0x1314448000000000ULL, 0xbc143fa4e250eb31ULL, 0x17d955a000000000ULL,
+            0xeb194f8e1ae525fdULL, 0x5dcfab0800000000ULL, 0x92efd1b8d0cf37beULL, 0x5aa1cae500000000ULL,
+            0xb7abc627050305adULL, 0xf14a3d9e40000000ULL, 0xe596b7b0c643c719ULL, 0x6d9ccd05d0000000ULL,
+            0x8f7e32ce7bea5c6fULL, 0xe4820023a2000000ULL, 0xb35dbf821ae4f38bULL, 0xdda2802c8a800000ULL,
+            0xe0352f62a19e306eULL, 0xd50b2037ad200000ULL, 0x8c213d9da502de45ULL, 0x4526f422cc340000ULL,
+            0xaf298d050e4395d6ULL, 0x9670b12b7f410000ULL, 0xdaf3f04651d47b4cULL, 0x3c0cdd765f114000ULL,
+            0x88d8762bf324cd0fULL, 0xa5880a69fb6ac800ULL, 0xab0e93b6efee0053ULL, 0x8eea0d047a457a00ULL,
+            0xd5d238a4abe98068ULL, 0x72a4904598d6d880ULL, 0x85a36366eb71f041ULL, 0x47a6da2b7f864750ULL,
+            0xa70c3c40a64e6c51ULL, 0x999090b65f67d924ULL, 0xd0cf4b50cfe20765ULL, 0xfff4b4e3f741cf6dULL,
+            0x82818f1281ed449fULL, 0xbff8f10e7a8921a4ULL, 0xa321f2d7226895c7ULL, 0xaff72d52192b6a0dULL,
+            0xcbea6f8ceb02bb39ULL, 0x9bf4f8a69f764490ULL, 0xfee50b7025c36a08ULL, 0x02f236d04753d5b4ULL,
+            0x9f4f2726179a2245ULL, 0x01d762422c946590ULL, 0xc722f0ef9d80aad6ULL, 0x424d3ad2b7b97ef5ULL,
+            0xf8ebad2b84e0d58bULL, 0xd2e0898765a7deb2ULL, 0x9b934c3b330c8577ULL, 0x63cc55f49f88eb2fULL,
+            0xc2781f49ffcfa6d5ULL, 0x3cbf6b71c76b25fbULL, 0xf316271c7fc3908aULL, 0x8bef464e3945ef7aULL,
+            0x97edd871cfda3a56ULL, 0x97758bf0e3cbb5acULL, 0xbde94e8e43d0c8ecULL, 0x3d52eeed1cbea317ULL,
+            0xed63a231d4c4fb27ULL, 0x4ca7aaa863ee4bddULL, 0x945e455f24fb1cf8ULL, 0x8fe8caa93e74ef6aULL,
+            0xb975d6b6ee39e436ULL, 0xb3e2fd538e122b44ULL, 0xe7d34c64a9c85d44ULL, 0x60dbbca87196b616ULL,
+            0x90e40fbeea1d3a4aULL, 0xbc8955e946fe31cdULL, 0xb51d13aea4a488ddULL, 0x6babab6398bdbe41ULL,
+            0xe264589a4dcdab14ULL, 0xc696963c7eed2dd1ULL, 0x8d7eb76070a08aecULL, 0xfc1e1de5cf543ca2ULL,
+            0xb0de65388cc8ada8ULL, 0x3b25a55f43294bcbULL, 0xdd15fe86affad912ULL, 0x49ef0eb713f39ebeULL,
+            0x8a2dbf142dfcc7abULL, 0x6e3569326c784337ULL, 0xacb92ed9397bf996ULL, 0x49c2c37f07965404ULL,
+            0xd7e77a8f87daf7fbULL, 0xdc33745ec97be906ULL, 0x86f0ac99b4e8dafdULL, 0x69a028bb3ded71a3ULL,
+            0xa8acd7c0222311bcULL, 0xc40832ea0d68ce0cULL, 0xd2d80db02aabd62bULL, 0xf50a3fa490c30190ULL,
+            0x83c7088e1aab65dbULL, 0x792667c6da79e0faULL, 0xa4b8cab1a1563f52ULL, 0x577001b891185938ULL,
+            0xcde6fd5e09abcf26ULL, 0xed4c0226b55e6f86ULL, 0x80b05e5ac60b6178ULL, 0x544f8158315b05b4ULL,
+            0xa0dc75f1778e39d6ULL, 0x696361ae3db1c721ULL, 0xc913936dd571c84cULL, 0x03bc3a19cd1e38e9ULL,
+            0xfb5878494ace3a5fULL, 0x04ab48a04065c723ULL, 0x9d174b2dcec0e47bULL, 0x62eb0d64283f9c76ULL,
+            0xc45d1df942711d9aULL, 0x3ba5d0bd324f8394ULL, 0xf5746577930d6500ULL, 0xca8f44ec7ee36479ULL,
+            0x9968bf6abbe85f20ULL, 0x7e998b13cf4e1ecbULL, 0xbfc2ef456ae276e8ULL, 0x9e3fedd8c321a67eULL,
+            0xefb3ab16c59b14a2ULL, 0xc5cfe94ef3ea101eULL, 0x95d04aee3b80ece5ULL, 0xbba1f1d158724a12ULL,
+            0xbb445da9ca61281fULL, 0x2a8a6e45ae8edc97ULL, 0xea1575143cf97226ULL, 0xf52d09d71a3293bdULL,
+            0x924d692ca61be758ULL, 0x593c2626705f9c56ULL, 0xb6e0c377cfa2e12eULL, 0x6f8b2fb00c77836cULL,
+            0xe498f455c38b997aULL, 0x0b6dfb9c0f956447ULL, 0x8edf98b59a373fecULL, 0x4724bd4189bd5eacULL,
+            0xb2977ee300c50fe7ULL, 0x58edec91ec2cb657ULL, 0xdf3d5e9bc0f653e1ULL, 0x2f2967b66737e3edULL,
+            0x8b865b215899f46cULL, 0xbd79e0d20082ee74ULL, 0xae67f1e9aec07187ULL, 0xecd8590680a3aa11ULL,
+            0xda01ee641a708de9ULL, 0xe80e6f4820cc9495ULL, 0x884134fe908658b2ULL, 0x3109058d147fdcddULL,
+            0xaa51823e34a7eedeULL, 0xbd4b46f0599fd415ULL, 0xd4e5e2cdc1d1ea96ULL, 0x6c9e18ac7007c91aULL,
+            0x850fadc09923329eULL, 0x03e2cf6bc604ddb0ULL, 0xa6539930bf6bff45ULL, 0x84db8346b786151cULL,
+            0xcfe87f7cef46ff16ULL, 0xe612641865679a63ULL, 0x81f14fae158c5f6eULL, 0x4fcb7e8f3f60c07eULL,
+            0xa26da3999aef7749ULL, 0xe3be5e330f38f09dULL, 0xcb090c8001ab551cULL, 0x5cadf5bfd3072cc5ULL,
+            0xfdcb4fa002162a63ULL, 0x73d9732fc7c8f7f6ULL, 0x9e9f11c4014dda7eULL, 0x2867e7fddcdd9afaULL,
+            0xc646d63501a1511dULL, 0xb281e1fd541501b8ULL, 0xf7d88bc24209a565ULL, 0x1f225a7ca91a4226ULL,
+            0x9ae757596946075fULL, 0x3375788de9b06958ULL, 0xc1a12d2fc3978937ULL, 0x0052d6b1641c83aeULL,
+            0xf209787bb47d6b84ULL, 0xc0678c5dbd23a49aULL, 0x9745eb4d50ce6332ULL, 0xf840b7ba963646e0ULL,
+            0xbd176620a501fbffULL, 0xb650e5a93bc3d898ULL, 0xec5d3fa8ce427affULL, 0xa3e51f138ab4cebeULL,
+            0x93ba47c980e98cdfULL, 0xc66f336c36b10137ULL, 0xb8a8d9bbe123f017ULL, 0xb80b0047445d4184ULL,
+            0xe6d3102ad96cec1dULL, 0xa60dc059157491e5ULL, 0x9043ea1ac7e41392ULL, 0x87c89837ad68db2fULL,
+            0xb454e4a179dd1877ULL, 0x29babe4598c311fbULL, 0xe16a1dc9d8545e94ULL, 0xf4296dd6fef3d67aULL,
+            0x8ce2529e2734bb1dULL, 0x1899e4a65f58660cULL, 0xb01ae745b101e9e4ULL, 0x5ec05dcff72e7f8fULL,
+            0xdc21a1171d42645dULL, 0x76707543f4fa1f73ULL, 0x899504ae72497ebaULL, 0x6a06494a791c53a8ULL,
+            0xabfa45da0edbde69ULL, 0x0487db9d17636892ULL, 0xd6f8d7509292d603ULL, 0x45a9d2845d3c42b6ULL,
+            0x865b86925b9bc5c2ULL, 0x0b8a2392ba45a9b2ULL, 0xa7f26836f282b732ULL, 0x8e6cac7768d7141eULL,
+            0xd1ef0244af2364ffULL, 0x3207d795430cd926ULL, 0x8335616aed761f1fULL, 0x7f44e6bd49e807b8ULL,
+            0xa402b9c5a8d3a6e7ULL, 0x5f16206c9c6209a6ULL, 0xcd036837130890a1ULL, 0x36dba887c37a8c0fULL,
+            0x802221226be55a64ULL, 0xc2494954da2c9789ULL, 0xa02aa96b06deb0fdULL, 0xf2db9baa10b7bd6cULL,
+            0xc83553c5c8965d3dULL, 0x6f92829494e5acc7ULL, 0xfa42a8b73abbf48cULL, 0xcb772339ba1f17f9ULL,
+            0x9c69a97284b578d7ULL, 0xff2a760414536efbULL, 0xc38413cf25e2d70dULL, 0xfef5138519684abaULL,
+            0xf46518c2ef5b8cd1ULL, 0x7eb258665fc25d69ULL, 0x98bf2f79d5993802ULL, 0xef2f773ffbd97a61ULL,
+            0xbeeefb584aff8603ULL, 0xaafb550ffacfd8faULL, 0xeeaaba2e5dbf6784ULL, 0x95ba2a53f983cf38ULL,
+            0x952ab45cfa97a0b2ULL, 0xdd945a747bf26183ULL, 0xba756174393d88dfULL, 0x94f971119aeef9e4ULL,
+            0xe912b9d1478ceb17ULL, 0x7a37cd5601aab85dULL, 0x91abb422ccb812eeULL, 0xac62e055c10ab33aULL,
+            0xb616a12b7fe617aaULL, 0x577b986b314d6009ULL, 0xe39c49765fdf9d94ULL, 0xed5a7e85fda0b80bULL,
+            0x8e41ade9fbebc27dULL, 0x14588f13be847307ULL, 0xb1d219647ae6b31cULL, 0x596eb2d8ae258fc8ULL,
+            0xde469fbd99a05fe3ULL, 0x6fca5f8ed9aef3bbULL, 0x8aec23d680043beeULL, 0x25de7bb9480d5854ULL,
+            0xada72ccc20054ae9ULL, 0xaf561aa79a10ae6aULL, 0xd910f7ff28069da4ULL, 0x1b2ba1518094da04ULL,
+            0x87aa9aff79042286ULL, 0x90fb44d2f05d0842ULL, 0xa99541bf57452b28ULL, 0x353a1607ac744a53ULL,
+            0xd3fa922f2d1675f2ULL, 0x42889b8997915ce8ULL, 0x847c9b5d7c2e09b7ULL, 0x69956135febada11ULL,
+            0xa59bc234db398c25ULL, 0x43fab9837e699095ULL, 0xcf02b2c21207ef2eULL, 0x94f967e45e03f4bbULL,
+            0x8161afb94b44f57dULL, 0x1d1be0eebac278f5ULL, 0xa1ba1ba79e1632dcULL, 0x6462d92a69731732ULL,
+            0xca28a291859bbf93ULL, 0x7d7b8f7503cfdcfeULL, 0xfcb2cb35e702af78ULL, 0x5cda735244c3d43eULL,
+            0x9defbf01b061adabULL, 0x3a0888136afa64a7ULL, 0xc56baec21c7a1916ULL, 0x088aaa1845b8fdd0ULL,
+            0xf6c69a72a3989f5bULL, 0x8aad549e57273d45ULL, 0x9a3c2087a63f6399ULL, 0x36ac54e2f678864bULL,
+            0xc0cb28a98fcf3c7fULL, 0x84576a1bb416a7ddULL, 0xf0fdf2d3f3c30b9fULL, 0x656d44a2a11c51d5ULL,
+            0x969eb7c47859e743ULL, 0x9f644ae5a4b1b325ULL, 0xbc4665b596706114ULL, 0x873d5d9f0dde1feeULL,
+            0xeb57ff22fc0c7959ULL, 0xa90cb506d155a7eaULL, 0x9316ff75dd87cbd8ULL, 0x09a7f12442d588f2ULL,
+            0xb7dcbf5354e9beceULL, 0x0c11ed6d538aeb2fULL, 0xe5d3ef282a242e81ULL, 0x8f1668c8a86da5faULL,
+            0x8fa475791a569d10ULL, 0xf96e017d694487bcULL, 0xb38d92d760ec4455ULL, 0x37c981dcc395a9acULL,
+            0xe070f78d3927556aULL, 0x85bbe253f47b1417ULL, 0x8c469ab843b89562ULL, 0x93956d7478ccec8eULL,
+            0xaf58416654a6babbULL, 0x387ac8d1970027b2ULL, 0xdb2e51bfe9d0696aULL, 0x06997b05fcc0319eULL,
+            0x88fcf317f22241e2ULL, 0x441fece3bdf81f03ULL, 0xab3c2fddeeaad25aULL, 0xd527e81cad7626c3ULL,
+            0xd60b3bd56a5586f1ULL, 0x8a71e223d8d3b074ULL, 0x85c7056562757456ULL, 0xf6872d5667844e49ULL,
+            0xa738c6bebb12d16cULL, 0xb428f8ac016561dbULL, 0xd106f86e69d785c7ULL, 0xe13336d701beba52ULL,
+            0x82a45b450226b39cULL, 0xecc0024661173473ULL, 0xa34d721642b06084ULL, 0x27f002d7f95d0190ULL,
+            0xcc20ce9bd35c78a5ULL, 0x31ec038df7b441f4ULL, 0xff290242c83396ceULL, 0x7e67047175a15271ULL,
+            0x9f79a169bd203e41ULL, 0x0f0062c6e984d386ULL, 0xc75809c42c684dd1ULL, 0x52c07b78a3e60868ULL,
+            0xf92e0c3537826145ULL, 0xa7709a56ccdf8a82ULL, 0x9bbcc7a142b17ccbULL, 0x88a66076400bb691ULL,
+            0xc2abf989935ddbfeULL, 0x6acff893d00ea435ULL, 0xf356f7ebf83552feULL, 0x0583f6b8c4124d43ULL,
+            0x98165af37b2153deULL, 0xc3727a337a8b704aULL, 0xbe1bf1b059e9a8d6ULL, 0x744f18c0592e4c5cULL,
+            0xeda2ee1c7064130cULL, 0x1162def06f79df73ULL, 0x9485d4d1c63e8be7ULL, 0x8addcb5645ac2ba8ULL,
+            0xb9a74a0637ce2ee1ULL, 0x6d953e2bd7173692ULL, 0xe8111c87c5c1ba99ULL, 0xc8fa8db6ccdd0437ULL,
+            0x910ab1d4db9914a0ULL, 0x1d9c9892400a22a2ULL, 0xb54d5e4a127f59c8ULL, 0x2503beb6d00cab4bULL,
+            0xe2a0b5dc971f303aULL, 0x2e44ae64840fd61dULL, 0x8da471a9de737e24ULL, 0x5ceaecfed289e5d2ULL,
+            0xb10d8e1456105dadULL, 0x7425a83e872c5f47ULL, 0xdd50f1996b947518ULL, 0xd12f124e28f77719ULL,
+            0x8a5296ffe33cc92fULL, 0x82bd6b70d99aaa6fULL, 0xace73cbfdc0bfb7bULL, 0x636cc64d1001550bULL,
+            0xd8210befd30efa5aULL, 0x3c47f7e05401aa4eULL, 0x8714a775e3e95c78ULL, 0x65acfaec34810a71ULL,
+            0xa8d9d1535ce3b396ULL, 0x7f1839a741a14d0dULL, 0xd31045a8341ca07cULL, 0x1ede48111209a050ULL,
+            0x83ea2b892091e44dULL, 0x934aed0aab460432ULL, 0xa4e4b66b68b65d60ULL, 0xf81da84d5617853fULL,
+            0xce1de40642e3f4b9ULL, 0x36251260ab9d668eULL, 0x80d2ae83e9ce78f3ULL, 0xc1d72b7c6b426019ULL,
+            0xa1075a24e4421730ULL, 0xb24cf65b8612f81fULL, 0xc94930ae1d529cfcULL, 0xdee033f26797b627ULL,
+            0xfb9b7cd9a4a7443cULL, 0x169840ef017da3b1ULL, 0x9d412e0806e88aa5ULL, 0x8e1f289560ee864eULL,
+            0xc491798a08a2ad4eULL, 0xf1a6f2bab92a27e2ULL, 0xf5b5d7ec8acb58a2ULL, 0xae10af696774b1dbULL,
+            0x9991a6f3d6bf1765ULL, 0xacca6da1e0a8ef29ULL, 0xbff610b0cc6edd3fULL, 0x17fd090a58d32af3ULL,
+            0xeff394dcff8a948eULL, 0xddfc4b4cef07f5b0ULL, 0x95f83d0a1fb69cd9ULL, 0x4abdaf101564f98eULL,
+            0xbb764c4ca7a4440fULL, 0x9d6d1ad41abe37f1ULL, 0xea53df5fd18d5513ULL, 0x84c86189216dc5edULL,
+            0x92746b9be2f8552cULL, 0x32fd3cf5b4e49bb4ULL, 0xb7118682dbb66a77ULL, 0x3fbc8c33221dc2a1ULL,
+            0xe4d5e82392a40515ULL, 0x0fabaf3feaa5334aULL, 0x8f05b1163ba6832dULL, 0x29cb4d87f2a7400eULL,
+            0xb2c71d5bca9023f8ULL, 0x743e20e9ef511012ULL, 0xdf78e4b2bd342cf6ULL, 0x914da9246b255416ULL,
+            0x8bab8eefb6409c1aULL, 0x1ad089b6c2f7548eULL, 0xae9672aba3d0c320ULL, 0xa184ac2473b529b1ULL,
+            0xda3c0f568cc4f3e8ULL, 0xc9e5d72d90a2741eULL, 0x8865899617fb1871ULL, 0x7e2fa67c7a658892ULL,
+            0xaa7eebfb9df9de8dULL, 0xddbb901b98feeab7ULL, 0xd51ea6fa85785631ULL, 0x552a74227f3ea565ULL,
+            0x8533285c936b35deULL, 0xd53a88958f87275fULL, 0xa67ff273b8460356ULL, 0x8a892abaf368f137ULL,
+            0xd01fef10a657842cULL, 0x2d2b7569b0432d85ULL, 0x8213f56a67f6b29bULL, 0x9c3b29620e29fc73ULL,
+            0xa298f2c501f45f42ULL, 0x8349f3ba91b47b8fULL, 0xcb3f2f7642717713ULL, 0x241c70a936219a73ULL,
+            0xfe0efb53d30dd4d7ULL, 0xed238cd383aa0110ULL, 0x9ec95d1463e8a506ULL, 0xf4363804324a40aaULL,
+            0xc67bb4597ce2ce48ULL, 0xb143c6053edcd0d5ULL, 0xf81aa16fdc1b81daULL, 0xdd94b7868e94050aULL,
+            0x9b10a4e5e9913128ULL, 0xca7cf2b4191c8326ULL, 0xc1d4ce1f63f57d72ULL, 0xfd1c2f611f63a3f0ULL,
+            0xf24a01a73cf2dccfULL, 0xbc633b39673c8cecULL, 0x976e41088617ca01ULL, 0xd5be0503e085d813ULL,
+            0xbd49d14aa79dbc82ULL, 0x4b2d8644d8a74e18ULL, 0xec9c459d51852ba2ULL, 0xddf8e7d60ed1219eULL,
+            0x93e1ab8252f33b45ULL, 0xcabb90e5c942b503ULL, 0xb8da1662e7b00a17ULL, 0x3d6a751f3b936243ULL,
+            0xe7109bfba19c0c9dULL, 0x0cc512670a783ad4ULL, 0x906a617d450187e2ULL, 0x27fb2b80668b24c5ULL,
+            0xb484f9dc9641e9daULL, 0xb1f9f660802dedf6ULL, 0xe1a63853bbd26451ULL, 0x5e7873f8a0396973ULL,
+            0x8d07e33455637eb2ULL, 0xdb0b487b6423e1e8ULL, 0xb049dc016abc5e5fULL, 0x91ce1a9a3d2cda62ULL,
+            0xdc5c5301c56b75f7ULL, 0x7641a140cc7810fbULL, 0x89b9b3e11b6329baULL, 0xa9e904c87fcb0a9dULL,
+            0xac2820d9623bf429ULL, 0x546345fa9fbdcd44ULL, 0xd732290fbacaf133ULL, 0xa97c177947ad4095ULL,
+            0x867f59a9d4bed6c0ULL, 0x49ed8eabcccc485dULL, 0xa81f301449ee8c70ULL, 0x5c68f256bfff5a74ULL,
+            0xd226fc195c6a2f8cULL, 0x73832eec6fff3111ULL, 0x83585d8fd9c25db7ULL, 0xc831fd53c5ff7eabULL,
+            0xa42e74f3d032f525ULL, 0xba3e7ca8b77f5e55ULL, 0xcd3a1230c43fb26fULL, 0x28ce1bd2e55f35ebULL,
+            0x80444b5e7aa7cf85ULL, 0x7980d163cf5b81b3ULL, 0xa0555e361951c366ULL, 0xd7e105bcc332621fULL,
+            0xc86ab5c39fa63440ULL, 0x8dd9472bf3fefaa7ULL, 0xfa856334878fc150ULL, 0xb14f98f6f0feb951ULL,
+            0x9c935e00d4b9d8d2ULL, 0x6ed1bf9a569f33d3ULL, 0xc3b8358109e84f07ULL, 0x0a862f80ec4700c8ULL,
+            0xf4a642e14c6262c8ULL, 0xcd27bb612758c0faULL, 0x98e7e9cccfbd7dbdULL, 0x8038d51cb897789cULL,
+            0xbf21e44003acdd2cULL, 0xe0470a63e6bd56c3ULL, 0xeeea5d5004981478ULL, 0x1858ccfce06cac74ULL,
+            0x95527a5202df0ccbULL, 0x0f37801e0c43ebc8ULL, 0xbaa718e68396cffdULL, 0xd30560258f54e6baULL,
+            0xe950df20247c83fdULL, 0x47c6b82ef32a2069ULL, 0x91d28b7416cdd27eULL, 0x4cdc331d57fa5441ULL,
+            0xb6472e511c81471dULL, 0xe0133fe4adf8e952ULL, 0xe3d8f9e563a198e5ULL, 0x58180fddd97723a6ULL,
+            0x8e679c2f5e44ff8fULL, 0x570f09eaa7ea7648ULL
+        };
+        return table;
+    }
+};
+
+// Stage one of Options::structuralIndex, also the scanner behind parseParallel() and skip(). Classifies the input in
+// 64 byte blocks and finds every structural character ({}[]:,), every quote and the first byte of every scalar
+// outside of strings.
+class JSONStructuralIndex {
+public:
+    // Writes the offset of every token, closing quotes included, to out followed by size as a sentinel. out needs
+    // room for size + 65 offsets, at most one per byte plus 64 written ahead. size must be below UINT32_MAX.
+    static void build(const char* data, size_t size, uint32_t* out) {
+        Collector collector(out);
+        scan(data, size, collector);
+        out[collector.count] = static_cast<uint32_t>(size);
+    }
+
+    // Calls visitor.block(base, bits, closing) for every 64 byte block, bit i of bits marks offset base + i.
+    // bits has the opening quote of every string, closing has the quotes that end them.
+    template<typename Visitor>
+    static void scan(const char* data, size_t size, Visitor& visitor) {
+        uint64_t prevEscaped = 0;
+        uint64_t prevInString = 0;
+        uint64_t prevScalar = 0;
+        char tail[64];
+
+        for (size_t base = 0; base < size; base += 64) {
+            const char* block = data + base;
+            if (size - base < 64) {
+                memset(tail, ' ', sizeof(tail));
+                memcpy(tail, block, size - base);
+                block = tail;
+            }
+
+            Masks m;
+            classify(block, m);
+
+            uint64_t escaped = findEscaped(m.backslash, prevEscaped);
+            uint64_t quote = m.quote & ~escaped;
+            uint64_t inString = prefixXor(quote) ^ prevInString;
+            prevInString = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+
+            uint64_t op = m.op & ~inString;
+            uint64_t scalar = ~(m.op | m.whitespace | quote | inString);
+            uint64_t scalarStart = scalar & ~((scalar << 1) | prevScalar);
+            prevScalar = scalar >> 63;
+
+            visitor.block(base, op | scalarStart | (quote & inString), quote & ~inString);
+        }
+    }
+
+    // Returns the offset just past the bracket that closes depth open arrays and objects, or SIZE_MAX when the
+    // input ends first. pos must not be inside a string. Only quotes, escapes and brackets are looked at, so
+    // blocks that cannot close the last level cost a few popcounts.
+    static size_t skip(const char* data, size_t size, size_t pos, size_t depth = 1) {
+#if defined(JSON_HAS_AVX2) || defined(JSON_HAS_SSE2)
+        uint64_t prevEscaped = 0;
+        uint64_t prevInString = 0;
+        char tail[64];
+
+        for (size_t base = pos; base < size; base += 64) {
+            const char* block = data + base;
+            if (size - base < 64) {
+                memset(tail, ' ', sizeof(tail));
+                memcpy(tail, block, size - base);
+                block = tail;
+            }
+
+            Masks m;
+            classify(block, m);
+
+            uint64_t escaped = findEscaped(m.backslash, prevEscaped);
+            uint64_t quote = m.quote & ~escaped;
+            uint64_t inString = prefixXor(quote) ^ prevInString;
+            prevInString = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+
+            uint64_t open = m.open & ~inString;
+            uint64_t close = m.close & ~inString;
+            size_t closes = popcount(close);
+            if (closes < depth) {
+                depth += popcount(open) - closes;
+                continue;
+            }
+
+            for (uint64_t brackets = open | close; brackets; brackets &= brackets - 1) {
+                int i = ctz(brackets);
+                if (open >> i & 1)
+                    depth++;
+                else if (--depth == 0)
+                    return base + i + 1;
+            }
+        }
+#else
+        // Classifying blocks without vector compares is slower than a plain byte loop.
+        while (pos < size) {
+            char ch = data[pos++];
+            if (ch == '"') {
+                while (pos < size && data[pos] != '"')
+                    pos += data[pos] == '\\' ? 2 : 1;
+                pos++;
+            } else if (ch == '{' || ch == '[') {
+                depth++;
+            } else if ((ch == '}' || ch == ']') && --depth == 0) {
+                return pos;
+            }
+        }
+#endif
+
+        return SIZE_MAX;
+    }
+
+    static int ctz(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(x);
+#else
+        int n = 0;
+        while (!(x & 1)) { x >>= 1; ++n; }
+        return n;
+#endif
+    }
+
+    static size_t popcount(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<size_t>(__builtin_popcountll(x));
+#else
+        size_t n = 0;
+        for (; x; x &= x - 1) ++n;
+        return n;
+#endif
+    }
+
+private:
+    struct Collector {
+        explicit Collector(uint32_t* out) : out(out), count(0) {}
+
+        void block(size_t base, uint64_t bits, uint64_t closing) {
+            bits |= closing;
+            // Eight offsets per step without a branch for each, the ones past the last token are overwritten by the
+            // next block. Bit 63 keeps ctz() defined once bits has run out.
+            uint32_t* offsets = out + count;
+            count += popcount(bits);
+            while (bits) {
+                for (int i = 0; i < 8; ++i) {
+                    offsets[i] = static_cast<uint32_t>(base + ctz(bits | 1ULL << 63));
+                    bits &= bits - 1;
+                }
+                offsets += 8;
+            }
+        }
+
+        uint32_t* out;
+        size_t count;
+    };
+
+    struct Masks {
+        uint64_t quote;
+        uint64_t backslash;
+        uint64_t open;  // '{' and '['
+        uint64_t close; // '}' and ']'
+        uint64_t op;    // Brackets, ':' and ','
+        uint64_t whitespace; // As isspace() in the C locale: space and '\t' to '\r'
+    };
+
+    // Bit i is set when an odd number of quotes precede or sit at position i, i.e. the byte is inside a string.
+    static uint64_t prefixXor(uint64_t x) {
+#ifdef JSON_HAS_PCLMUL
+        __m128i all = _mm_set1_epi8(static_cast<char>(0xFF));
+        __m128i result = _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<long long>(x)), all, 0);
+        return static_cast<uint64_t>(_mm_cvtsi128_si64(result));
+#else
+        x ^= x << 1;
+        x ^= x << 2;
+        x ^= x << 4;
+        x ^= x << 8;
+        x ^= x << 16;
+        x ^= x << 32;
+        return x;
+#endif
+    }
+
+    // Marks bytes preceded by an odd run of backslashes, carrying runs across block boundaries.
+    static uint64_t findEscaped(uint64_t backslash, uint64_t& prevEscaped) {
+        const uint64_t evenBits = 0x5555555555555555ULL;
+        backslash &= ~prevEscaped;
+        uint64_t followsEscape = (backslash << 1) | prevEscaped;
+        uint64_t oddStarts = backslash & ~evenBits & ~followsEscape;
+        uint64_t evenStartSequences = oddStarts + backslash;
+        prevEscaped = evenStartSequences < oddStarts ? 1 : 0;
+        uint64_t invertMask = evenStartSequences << 1;
+        return (evenBits ^ invertMask) & followsEscape;
+    }
+
+#if defined(JSON_HAS_AVX2)
+    static uint64_t bits(__m256i lo, __m256i hi) {
+        uint64_t l = static_cast<uint32_t>(_mm256_movemask_epi8(lo));
+        uint64_t h = static_cast<uint32_t>(_mm256_movemask_epi8(hi));
+        return l | (h << 32);
+    }
+
+    static uint64_t eq(__m256i lo, __m256i hi, char c) {
+        __m256i v = _mm256_set1_epi8(c);
+        return bits(_mm256_cmpeq_epi8(lo, v), _mm256_cmpeq_epi8(hi, v));
+    }
+
+    static void classify(const char* block, Masks& m) {
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+        // '[' and ']' only differ from '{' and '}' by bit 0x20.
+        __m256i caseBit = _mm256_set1_epi8(0x20);
+        __m256i loFolded = _mm256_or_si256(lo, caseBit);
+        __m256i hiFolded = _mm256_or_si256(hi, caseBit);
+
+        m.quote = eq(lo, hi, '"');
+        m.backslash = eq(lo, hi, '\\');
+        m.open = eq(loFolded, hiFolded, '{');
+        m.close = eq(loFolded, hiFolded, '}');
+        m.op = m.open | m.close | eq(lo, hi, ':') | eq(lo, hi, ',');
+        // '\t' to '\r' are the only bytes that stay at zero when 9 is subtracted and 4 more taken off saturating.
+        __m256i zero = _mm256_setzero_si256();
+        __m256i loControl = _mm256_subs_epu8(_mm256_sub_epi8(lo, _mm256_set1_epi8(9)), _mm256_set1_epi8(4));
+        __m256i hiControl = _mm256_subs_epu8(_mm256_sub_epi8(hi, _mm256_set1_epi8(9)), _mm256_set1_epi8(4));
+        m.whitespace = eq(lo, hi, ' ') | bits(_mm256_cmpeq_epi8(loControl, zero), _mm256_cmpeq_epi8(hiControl, zero));
+    }
+#elif defined(JSON_HAS_SSE2)
+    static uint64_t eq(const __m128i* v, char c) {
+        __m128i needle = _mm_set1_epi8(c);
+        uint64_t result = 0;
+        for (int i = 0; i < 4; ++i) {
+            uint64_t bits = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v[i], needle)));
+            result |= bits << (16 * i);
+        }
+        return result;
+    }
+
+    static void classify(const char* block, Masks& m) {
+        __m128i v[4], folded[4], control[4];
+        __m128i caseBit = _mm_set1_epi8(0x20);
+        for (int i = 0; i < 4; ++i) {
+            v[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+            folded[i] = _mm_or_si128(v[i], caseBit);
+            // '\t' to '\r' are the only bytes that end up at zero.
+            control[i] = _mm_subs_epu8(_mm_sub_epi8(v[i], _mm_set1_epi8(9)), _mm_set1_epi8(4));
+        }
+
+        m.quote = eq(v, '"');
+        m.backslash = eq(v, '\\');
+        m.open = eq(folded, '{');
+        m.close = eq(folded, '}');
+        m.op = m.open | m.close | eq(v, ':') | eq(v, ',');
+        m.whitespace = eq(v, ' ') | eq(control, 0);
+    }
+#else
+    static void classify(const char* block, Masks& m) {
+        m.quote = m.backslash = m.open = m.close = m.op = m.whitespace = 0;
+        for (int i = 0; i < 64; ++i) {
+            uint64_t bit = 1ULL << i;
+            switch (block[i]) {
+                case '"': m.quote |= bit; break;
+                case '\\': m.backslash |= bit; break;
+                case '{': case '[': m.open |= bit; m.op |= bit; break;
+                case '}': case ']': m.close |= bit; m.op |= bit; break;
+                case ':': case ',': m.op |= bit; break;
+                case ' ': case '\t': case '\n': case '\v': case '\f': case '\r': m.whitespace |= bit; break;
+                default: break;
+            }
+        }
+    }
+#endif
+};
+
+// UTF-8 validation for JSONParser::Options::validateUtf8. With AVX2 or SSSE3 it uses the lookup algorithm of Keiser
+// and Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte", on 64 byte blocks. Builds for plain x86-64
+// with GCC or Clang choose between the two at runtime. The other builds skip ASCII runs a word at a time and decode
+// the rest.
+class JSONUtf8 {
+public:
+    // Returns size if data is valid UTF-8, otherwise the offset of the first byte of the first invalid sequence.
+    static size_t validate(const char* data, size_t size) {
+        const unsigned char* s = reinterpret_cast<const unsigned char*>(data);
+#if defined(JSON_HAS_AVX2)
+        return validateAvx2(s, size);
+#elif defined(JSON_HAS_DISPATCH)
+        static const Kernel kernel = selectKernel();
+        return kernel(s, size);
+#elif defined(JSON_HAS_SSSE3)
+        return validateSsse3(s, size);
+#else
+        return validateScalar(s, 0, size);
+#endif
+    }
+
+private:
+#if defined(JSON_HAS_DISPATCH)
+    typedef size_t (*Kernel)(const unsigned char* s, size_t size);
+
+    static Kernel selectKernel() {
+        // Needed when the first call comes from a static constructor.
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return validateAvx2;
+#if !defined(JSON_HAS_SSSE3)
+        if (!__builtin_cpu_supports("ssse3"))
+            return validateFallback;
+#endif
+        return validateSsse3;
+    }
+
+    static size_t validateFallback(const unsigned char* s, size_t size) {
+        return validateScalar(s, 0, size);
+    }
+#endif
+
+#if defined(JSON_HAS_AVX2) || defined(JSON_HAS_DISPATCH)
+    JSON_TARGET("avx2")
+    static size_t validateAvx2(const unsigned char* s, size_t size) {
+        __m256i prev = _mm256_setzero_si256();
+        __m256i prevIncomplete = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 64 <= size; i += 64) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i + 32));
+            __m256i error;
+            if (_mm256_movemask_epi8(_mm256_or_si256(a, b)) == 0) {
+                // An all ASCII block can only be wrong by not finishing a sequence of the previous one.
+                error = prevIncomplete;
+                prevIncomplete = _mm256_setzero_si256();
+            } else {
+                error = _mm256_or_si256(check(a, prev), check(b, a));
+                prevIncomplete = incomplete(b);
+            }
+            prev = b;
+
+            // The scalar pass pins down the exact offset, it starts at the sequence the block may begin inside of.
+            if (!_mm256_testz_si256(error, error))
+                return validateScalar(s, boundary(s, i), size);
+        }
+        return validateScalar(s, boundary(s, i), size);
+    }
+#endif
+
+#if defined(JSON_HAS_SSSE3) || defined(JSON_HAS_DISPATCH)
+    JSON_TARGET("ssse3")
+    static size_t validateSsse3(const unsigned char* s, size_t size) {
+        __m128i prev = _mm_setzero_si128();
+        __m128i prevIncomplete = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 64 <= size; i += 64) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + 16));
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + 32));
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + 48));
+            __m128i error;
+            if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d))) == 0) {
+                error = prevIncomplete;
+                prevIncomplete = _mm_setzero_si128();
+            } else {
+                error = _mm_or_si128(_mm_or_si128(check(a, prev), check(b, a)), _mm_or_si128(check(c, b), check(d, c)));
+                prevIncomplete = incomplete(d);
+            }
+            prev = d;
+
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) != 0xFFFF)
+                return validateScalar(s, boundary(s, i), size);
+        }
+        return validateScalar(s, boundary(s, i), size);
+    }
+#endif
+
+    // Start of the character that covers offset i, or i if a character starts there.
+    static size_t boundary(const unsigned char* s, size_t i) {
+        for (size_t back = 1; back <= 3 && back <= i; ++back) {
+            unsigned char c = s[i - back];
+            if (c >= 0xC0)
+                return sequenceLength(c) > back ? i - back : i;
+            if (c < 0x80)
+                return i;
+        }
+        return i;
+    }
+
+    static size_t sequenceLength(unsigned char c) {
+        return c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+    }
+
+    static size_t validateScalar(const unsigned char* s, size_t i, size_t size) {
+        while (i < size) {
+#if defined(JSON_HAS_SSE2)
+            if (i + 16 <= size && _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i))) == 0) {
+                i += 16;
+                continue;
+            }
+#else
+            uint64_t word;
+            if (i + 8 <= size && (memcpy(&word, s + i, 8), (word & 0x8080808080808080ULL) == 0)) {
+                i += 8;
+                continue;
+            }
+#endif
+            unsigned char c = s[i];
+            if (c < 0x80) {
+                i++;
+                continue;
+            }
+
+            if (c < 0xC2 || c > 0xF4)
+                return i;
+
+            size_t length = sequenceLength(c);
+            if (size - i < length)
+                return i;
+
+            uint32_t code = c & (0x7F >> length);
+            for (size_t k = 1; k < length; ++k) {
+                if ((s[i + k] & 0xC0) != 0x80)
+                    return i;
+                code = (code << 6) | (s[i + k] & 0x3F);
+            }
+
+            // Overlong forms, surrogates and code points past U+10FFFF.
+            if ((length == 3 && code < 0x800) || (length == 4 && code < 0x10000) ||
+                (code >= 0xD800 && code <= 0xDFFF) || code > 0x10FFFF)
+                return i;
+            i += length;
+        }
+        return size;
+    }
+
+#if defined(JSON_HAS_AVX2) || defined(JSON_HAS_SSSE3) || defined(JSON_HAS_DISPATCH)
+    enum : uint8_t {
+        TooShort = 1 << 0,     // Lead byte followed by a lead or ASCII byte.
+        TooLong = 1 << 1,      // ASCII byte followed by a continuation.
+        Overlong3 = 1 << 2,
+        TooLarge = 1 << 3,
+        Surrogate = 1 << 4,
+        Overlong2 = 1 << 5,
+        TooLarge1000 = 1 << 6,
+        Overlong4 = 1 << 6,
+        TwoConts = 1 << 7,     // Continuation after a continuation, fine if it is the 3rd or 4th byte.
+        Carry = TooShort | TooLong | TwoConts
+    };
+
+    // The three nibble lookups, shared by both vector widths. Every error that a pair of bytes can show up as
+    // has one bit, a pair is wrong if all three lookups agree on some bit.
+    static const uint8_t* byte1HighTable() {
+        static const uint8_t table[16] = {
+            TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TooLong,
+            TwoConts, TwoConts, TwoConts, TwoConts,
+            TooShort | Overlong2,
+            TooShort,
+            TooShort | Overlong3 | Surrogate,
+            TooShort | TooLarge | TooLarge1000 | Overlong4
+        };
+        return table;
+    }
+
+    static const uint8_t* byte1LowTable() {
+        static const uint8_t table[16] = {
+            Carry | Overlong3 | Overlong2 | Overlong4,
+            Carry | Overlong2,
+            Carry,
+            Carry,
+            Carry | TooLarge,
+            Carry | TooLarge | TooLarge1000,
+            Carry | TooLarge | TooLarge1000,
+            Carry | TooLarge | TooLarge1000,
+            Carry | TooLarge | TooLarge1000,
+            Carry | TooLarge | TooLarge1000,
+            Carry | TooLarge | TooLarge1000,
+            Carry | TooLarge | TooLarge1000,
+            Carry | TooLarge | TooLarge1000,
+            Carry | TooLarge | TooLarge1000 | Surrogate,
+            Carry | TooLarge | TooLarge1000,
+            Carry | TooLarge | TooLarge1000
+        };
+        return table;
+    }
+
+    static const uint8_t* byte2HighTable() {
+        static const uint8_t table[16] = {
+            TooShort, TooShort, TooShort, TooShort, TooShort, TooShort, TooShort, TooShort,
+            TooLong | Overlong2 | TwoConts | Overlong3 | TooLarge1000 | Overlong4,
+            TooLong | Overlong2 | TwoConts | Overlong3 | TooLarge,
+            TooLong | Overlong2 | TwoConts | Surrogate | TooLarge,
+            TooLong | Overlong2 | TwoConts | Surrogate | TooLarge,
+            TooShort, TooShort, TooShort, TooShort
+        };
+        return table;
+    }
+#endif
+
+#if defined(JSON_HAS_AVX2) || defined(JSON_HAS_DISPATCH)
+    // Bytes of input shifted by n, pulling the last n bytes of prev in front.
+    template<int n>
+    JSON_TARGET("avx2")
+    static __m256i shifted(__m256i input, __m256i prev) {
+        return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev, input, 0x21), 16 - n);
+    }
+
+    JSON_TARGET("avx2")
+    static __m256i lookup(const uint8_t* table, __m256i nibbles) {
+        return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table))), nibbles);
+    }
+
+    JSON_TARGET("avx2")
+    static __m256i highNibble(__m256i v) {
+        return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+    }
+
+    JSON_TARGET("avx2")
+    static __m256i check(__m256i input, __m256i prev) {
+        __m256i prev1 = shifted<1>(input, prev);
+        __m256i byte1High = lookup(byte1HighTable(), highNibble(prev1));
+        __m256i byte1Low = lookup(byte1LowTable(), _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)));
+        __m256i byte2High = lookup(byte2HighTable(), highNibble(input));
+        __m256i special = _mm256_and_si256(_mm256_and_si256(byte1High, byte1Low), byte2High);
+
+        // Bytes two or three after a 3 or 4 byte lead must be continuations, which cancels TwoConts there.
+        __m256i third = _mm256_subs_epu8(shifted<2>(input, prev), _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+        __m256i fourth = _mm256_subs_epu8(shifted<3>(input, prev), _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+        __m256i mustContinue = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+        return _mm256_xor_si256(mustContinue, special);
+    }
+
+    // Non-zero if the block ends inside a multi-byte sequence, the next block has to complete it.
+    JSON_TARGET("avx2")
+    static __m256i incomplete(__m256i input) {
+        const __m256i limit = _mm256_setr_epi8(
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+        return _mm256_subs_epu8(input, limit);
+    }
+#endif
+
+#if defined(JSON_HAS_SSSE3) || defined(JSON_HAS_DISPATCH)
+    // Same as the AVX2 version on 16 byte vectors.
+    template<int n>
+    JSON_TARGET("ssse3")
+    static __m128i shifted(__m128i input, __m128i prev) {
+        return _mm_alignr_epi8(input, prev, 16 - n);
+    }
+
+    JSON_TARGET("ssse3")
+    static __m128i lookup(const uint8_t* table, __m128i nibbles) {
+        return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table)), nibbles);
+    }
+
+    JSON_TARGET("ssse3")
+    static __m128i highNibble(__m128i v) {
+        return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F));
+    }
+
+    JSON_TARGET("ssse3")
+    static __m128i check(__m128i input, __m128i prev) {
+        __m128i prev1 = shifted<1>(input, prev);
+        __m128i byte1High = lookup(byte1HighTable(), highNibble(prev1));
+        __m128i byte1Low = lookup(byte1LowTable(), _mm_and_si128(prev1, _mm_set1_epi8(0x0F)));
+        __m128i byte2High = lookup(byte2HighTable(), highNibble(input));
+        __m128i special = _mm_and_si128(_mm_and_si128(byte1High, byte1Low), byte2High);
+
+        __m128i third = _mm_subs_epu8(shifted<2>(input, prev), _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+        __m128i fourth = _mm_subs_epu8(shifted<3>(input, prev), _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+        __m128i mustContinue = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(static_cast<char>(0x80)));
+        return _mm_xor_si128(mustContinue, special);
+    }
+
+    JSON_TARGET("ssse3")
+    static __m128i incomplete(__m128i input) {
+        const __m128i limit = _mm_setr_epi8(
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+        return _mm_subs_epu8(input, limit);
+    }
+#endif
+};
+
+// Strict RFC 8259 check behind JSONParser::validate(). Nothing is built and nothing is allocated unless maxDepth is
+// raised above the default, container kinds are kept one bit per level. String contents are scanned with SIMD.
+class JSONValidator {
+public:
+    struct Result {
+        bool ok;
+        size_t offset;     // Where the input stops being valid JSON, size if it ends too early.
+        const char* error; // Static message, nullptr when ok.
+
+        explicit operator bool() const { return ok; }
+    };
+
+    static Result run(const char* data, size_t size, size_t maxDepth, bool validateUtf8) {
+        JSONValidator validator(data, size);
+        if (validateUtf8) {
+            size_t invalid = JSONUtf8::validate(data, size);
+            if (invalid != size) {
+                validator.pos = invalid;
+                validator.fail("Invalid UTF-8 in JSON");
+            }
+        }
+
+        if (!validator.error)
+            validator.document(maxDepth);
+
+        Result result = { validator.error == nullptr, validator.error ? validator.pos : size, validator.error };
+        return result;
+    }
+
+private:
+    enum { InlineLevels = 1024 };
+
+    const unsigned char* s;
+    size_t size;
+    size_t pos;
+    const char* error;
+    uint64_t* objects; // Bit per open container, set for objects.
+    uint64_t inlineObjects[InlineLevels / 64];
+    std::vector<uint64_t> deepObjects;
+
+    JSONValidator(const char* data, size_t size)
+    : s(reinterpret_cast<const unsigned char*>(data)), size(size), pos(0), error(nullptr), objects(inlineObjects) {}
+
+    bool fail(const char* message) {
+        if (pos > size)
+            pos = size;
+        error = message;
+        return false;
+    }
+
+    unsigned char peek() const {
+        return pos < size ? s[pos] : 0;
+    }
+
+    void whitespace() {
+        while (pos < size && (s[pos] == ' ' || s[pos] == '\n' || s[pos] == '\r' || s[pos] == '\t'))
+            pos++;
+    }
+
+    bool isObject(size_t level) const {
+        return objects[level / 64] >> (level % 64) & 1;
+    }
+
+    void setLevel(size_t level, bool object) {
+        uint64_t bit = 1ULL << (level % 64);
+        objects[level / 64] = object ? objects[level / 64] | bit : objects[level / 64] & ~bit;
+    }
+
+    bool document(size_t maxDepth) {
+        if (maxDepth > InlineLevels) {
+            deepObjects.assign((maxDepth + 63) / 64, 0);
+            objects = deepObjects.data();
+        }
+
+        size_t depth = 0;
+        for (;;) {
+            whitespace();
+            unsigned char ch = peek();
+            if (ch == '{' || ch == '[') {
+                if (depth >= maxDepth)
+                    return fail("Maximum nesting depth exceeded in JSON");
+
+                pos++;
+                whitespace();
+                if (peek() != (ch == '{' ? '}' : ']')) {
+                    setLevel(depth++, ch == '{');
+                    if (ch == '{' && !key())
+                        return false;
+                    continue;
+                }
+                pos++;
+            } else if (ch == '"') {
+                if (!string())
+                    return false;
+            } else if (ch == 't') {
+                if (!literal("true", 4))
+                    return false;
+            } else if (ch == 'f') {
+                if (!literal("false", 5))
+                    return false;
+            } else if (ch == 'n') {
+                if (!literal("null", 4))
+                    return false;
+            } else if (ch == '-' || (ch >= '0' && ch <= '9')) {
+                if (!number())
+                    return false;
+            } else {
+                return fail(pos < size ? "Unexpected character in JSON" : "Unexpected end of JSON");
+            }
+
+            // The value is complete, close finished containers until a ',' asks for the next member.
+            for (;;) {
+                whitespace();
+                if (depth == 0)
+                    return pos == size || fail("Unexpected character after JSON value");
+
+                bool object = isObject(depth - 1);
+                ch = peek();
+                if (ch == ',') {
+                    pos++;
+                    if (object) {
+                        whitespace();
+                        if (!key())
+                            return false;
+                    }
+                    break;
+                }
+                if (ch != (object ? '}' : ']'))
+                    return fail(object ? "Expected ',' or '}' in JSON object" : "Expected ',' or ']' in JSON array");
+                pos++;
+                depth--;
+            }
+        }
+    }
+
+    bool key() {
+        if (peek() != '"')
+            return fail("Expected string in JSON");
+        if (!string())
+            return false;
+
+        whitespace();
+        if (peek() != ':')
+            return fail("Expected ':' in JSON object");
+        pos++;
+        return true;
+    }
+
+    bool literal(const char* text, size_t length) {
+        if (size - pos < length || memcmp(s + pos, text, length) != 0)
+            return fail("Unexpected character in JSON");
+        pos += length;
+        return true;
+    }
+
+    bool digits() {
+        if (peek() < '0' || peek() > '9')
+            return false;
+        while (peek() >= '0' && peek() <= '9')
+            pos++;
+        return true;
+    }
+
+    bool number() {
+        if (peek() == '-')
+            pos++;
+
+        if (peek() == '0')
+            pos++;
+        else if (!digits())
+            return fail("Invalid number in JSON");
+
+        if (peek() == '.') {
+            pos++;
+            if (!digits())
+                return fail("Expected digit after '.' in JSON number");
+        }
+
+        if (peek() == 'e' || peek() == 'E') {
+            pos++;
+            if (peek() == '+' || peek() == '-')
+                pos++;
+            if (!digits())
+                return fail("Expected digit in JSON number exponent");
+        }
+        return true;
+    }
+
+    // Moves pos to the next quote, backslash or control character, or to size.
+    void scanString() {
+#if defined(JSON_HAS_AVX2)
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        const __m256i control = _mm256_set1_epi8(0x1F);
+        for (; pos + 32 <= size; pos += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + pos));
+            __m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash)),
+                                           _mm256_cmpeq_epi8(_mm256_max_epu8(v, control), control));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+            if (mask) {
+                pos += JSONStructuralIndex::ctz(mask);
+                return;
+            }
+        }
+#elif defined(JSON_HAS_SSE2)
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i control = _mm_set1_epi8(0x1F);
+        for (; pos + 16 <= size; pos += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + pos));
+            __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+                                        _mm_cmpeq_epi8(_mm_max_epu8(v, control), control));
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(hits));
+            if (mask) {
+                pos += JSONStructuralIndex::ctz(mask);
+                return;
+            }
+        }
+#endif
+        while (pos < size && s[pos] != '"' && s[pos] != '\\' && s[pos] >= 0x20)
+            pos++;
+    }
+
+    bool string() {
+        pos++;
+        for (;;) {
+            scanString();
+            if (pos >= size)
+                return fail("Unterminated string in JSON");
+
+            unsigned char ch = s[pos];
+            if (ch == '"') {
+                pos++;
+                return true;
+            }
+            if (ch < 0x20)
+                return fail("Control character in JSON string");
+
+            pos++;
+            switch (peek()) {
+                case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                    pos++;
+                    break;
+                case 'u':
+                    if (!escape())
+                        return false;
+                    break;
+                default:
+                    return fail("Invalid escape character in string");
+            }
+        }
+    }
+
+    // pos is on the 'u' of a \u escape. Surrogates must come in pairs, as JSONParser decodes them.
+    bool escape() {
+        uint32_t code;
+        if (!hex(code))
+            return false;
+        if (code >= 0xDC00 && code <= 0xDFFF)
+            return fail("Unpaired surrogate in string");
+        if (code < 0xD800 || code > 0xDBFF)
+            return true;
+
+        if (size - pos < 2 || s[pos] != '\\' || s[pos + 1] != 'u')
+            return fail("Unpaired surrogate in string");
+        pos++;
+        if (!hex(code))
+            return false;
+        if (code < 0xDC00 || code > 0xDFFF)
+            return fail("Unpaired surrogate in string");
+        return true;
+    }
+
+    // Reads the 4 hex digits after the 'u' at pos and leaves pos past them.
+    bool hex(uint32_t& code) {
+        code = 0;
+        for (int i = 0; i < 4; ++i) {
+            pos++;
+            unsigned char ch = peek();
+            uint32_t digit;
+            if (ch >= '0' && ch <= '9')
+                digit = ch - '0';
+            else if (ch >= 'a' && ch <= 'f')
+                digit = ch - 'a' + 10;
+            else if (ch >= 'A' && ch <= 'F')
+                digit = ch - 'A' + 10;
+            else
+                return fail("Invalid unicode escape in string");
+            code = (code << 4) | digit;
+        }
+        pos++;
+        return true;
+    }
+};
+
+template<typename Handler>
+class JSONChunkedParser;
+
+// Event interface of JSONParser::parse(data, size, handler). Derive from it and redefine the callbacks you need,
+// dispatch is resolved at compile time. Returning false from a callback stops parsing. String and key pointers
+// point into the input when the text has no escapes and into parser scratch otherwise, so they are only valid
+// for the duration of the call.
+class JSONHandler {
+public:
+    bool null() { return true; }
+    bool boolean(bool) { return true; }
+    bool integer(int64_t) { return true; }
+    bool unsignedInteger(uint64_t) { return true; }
+    bool number(double) { return true; }
+    bool string(const char*, size_t) { return true; }
+    bool key(const char*, size_t) { return true; }
+    bool startObject() { return true; }
+    bool endObject() { return true; }
+    bool startArray() { return true; }
+    bool endArray() { return true; }
+};
+
+// Handler that builds a JSON tree, every value is constructed in place inside its parent.
+class JSONBuilder : public JSONHandler {
+public:
+    // Containers and strings are allocated from the arena when one is given, see JSONDocument. With borrow set,
+    // string values reference the input instead of being copied, it must outlive the tree and needs an arena.
+    // Needs reset() before use.
+    JSONBuilder() : root(nullptr), arena(nullptr), borrow(false), pending(nullptr) {}
+
+    explicit JSONBuilder(JSON& root, JSONArena* arena = nullptr, bool borrow = false)
+    : root(&root), arena(arena), borrow(borrow), pending(nullptr) {}
+
+    // Builds the next document into root, keeping the capacity of the container stack.
+    void reset(JSON& root, JSONArena* arena = nullptr, bool borrow = false) {
+        this->root = &root;
+        this->arena = arena;
+        this->borrow = borrow;
+        pending = nullptr;
+        stack.clear();
+    }
+
+    bool null() { *slot() = JSON(); return true; }
+    bool boolean(bool b) { *slot() = JSON(b); return true; }
+    bool integer(int64_t i) { *slot() = JSON(i); return true; }
+    bool unsignedInteger(uint64_t u) { *slot() = JSON(u); return true; }
+    bool number(double d) { *slot() = JSON(d); return true; }
+    bool string(const char* str, size_t length) {
+        if (borrow)
+            slot()->makeStringRef(arena, str, length);
+        else
+            slot()->makeString(str, length, arena);
+        return true;
+    }
+
+    bool key(const char* str, size_t length) {
+        JSON::ObjectType& object = *stack.back()->object;
+        pending = &object[JSON::StringType(str, length, object.get_allocator())];
+        return true;
+    }
+
+    bool startObject() {
+        JSON* value = slot();
+        value->makeObject(arena);
+        stack.push_back(value);
+        return true;
+    }
+
+    bool startArray() {
+        JSON* value = slot();
+        value->makeArray(arena);
+        stack.push_back(value);
+        return true;
+    }
+
+    bool endObject() { stack.pop_back(); return true; }
+    bool endArray() { stack.pop_back(); return true; }
+
+private:
+    JSON* root;
+    JSONArena* arena;
+    bool borrow;
+    JSON* pending; // Value slot of the last key read.
+    std::vector<JSON*> stack;
+
+    JSON* slot() {
+        if (stack.empty())
+            return root;
+
+        JSON* container = stack.back();
+        if (container->type == JSON::Array) {
+            container->array->push_back(JSON());
+            return &container->array->back();
+        }
+        return pending;
+    }
+};
+
+class JSONParser {
+public:
+    struct Options {
+        // Index every token with the SIMD structural scanner first, then parse from the index without looking at
+        // whitespace or scanning strings for their end. Same results and errors. The index takes up to 4 bytes per
+        // input byte and is kept by a reused parser. Ignored without SSE2 or AVX2 and for inputs of 4 GB and larger.
+        bool structuralIndex;
+        // Deepest allowed nesting of arrays and objects, deeper input is rejected with an error.
+        size_t maxDepth;
+        // Reject input that is not valid UTF-8, the error reports where the first bad sequence starts.
+        bool validateUtf8;
+
+        Options() : structuralIndex(false), maxDepth(1024), validateUtf8(false) {}
+    };
+
+    // Reusable parser without input, see reset().
+    JSONParser() : data(nullptr), size(0), pos(0), structuralCapacity(0), streaming(false), streamOffset(0), insitu(nullptr) {}
+
+    // Parses directly over the caller's buffer, the input must outlive the parser.
+    JSONParser(const char* data, size_t size) : data(data), size(size), pos(0), structuralCapacity(0), streaming(false), streamOffset(0), insitu(nullptr) {}
+    JSONParser(const std::string& data) : data(data.data()), size(data.size()), pos(0), structuralCapacity(0), streaming(false), streamOffset(0), insitu(nullptr) {}
+    // A temporary would be gone before parsing starts.
+    JSONParser(std::string&&) = delete;
+    JSONParser(std::ifstream& f)
+    : buffer(std::string((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>())),
+      data(buffer.data()), size(buffer.size()), pos(0), structuralCapacity(0), streaming(false), streamOffset(0), insitu(nullptr) {}
+
+    JSONParser(const JSONParser&) = delete;
+    JSONParser& operator=(const JSONParser&) = delete;
+
+    static JSON parse(const char* data, size_t size, const Options& options = Options()) {
+        JSONParser parser(data, size);
+        return parser.parseDocument(options);
+    }
+
+    static JSON parse(const char* data) {
+        return parse(data, strlen(data));
+    }
+
+    static JSON parse(const std::string& data, const Options& options = Options()) {
+        return parse(data.data(), data.size(), options);
+    }
+
+    // Handler overloads only take class types other than Options, so a length of any integer type still picks
+    // parse(data, size) instead of deducing Handler from it.
+    template<typename Handler>
+    struct IsHandler : std::integral_constant<bool, std::is_class<Handler>::value && !std::is_same<Handler, Options>::value> {};
+
+    // Streams the document to handler instead of building a tree, see JSONHandler. Returns false if a callback
+    // stopped parsing.
+    template<typename Handler, typename = typename std::enable_if<IsHandler<Handler>::value>::type>
+    static bool parse(const char* data, size_t size, Handler& handler, const Options& options = Options()) {
+        JSONParser parser(data, size);
+        return parser.parseDocument(handler, options);
+    }
+
+    template<typename Handler, typename = typename std::enable_if<IsHandler<Handler>::value>::type>
+    static bool parse(const std::string& data, Handler& handler, const Options& options = Options()) {
+        return parse(data.data(), data.size(), handler, options);
+    }
+
+    // Like parse(data, size, handler) but unescapes strings and keys in place, so every string handed to the
+    // handler points into data and stays valid for as long as data does. The buffer is modified.
+    template<typename Handler>
+    static bool parseInsitu(char* data, size_t size, Handler& handler, const Options& options = Options()) {
+        JSONParser parser;
+        parser.resetInsitu(data, size);
+        return parser.parseDocument(handler, options);
+    }
+
+    // Validates and indexes the document but defers building arrays and objects until they are accessed.
+    // The input is copied into the document, so it does not need to outlive the result.
+    // Const access builds each container once behind the value without changing it, so a const lazy tree can be
+    // read from several threads. Non-const access replaces the Lazy value with the built container.
+    static JSON parseLazy(const char* data, size_t size, const Options& options = Options()) {
+        std::shared_ptr<JSONLazyDocument> document = std::make_shared<JSONLazyDocument>();
+        document->text.assign(data, size);
+
+        JSONParser parser(document->text);
+        LazyIndexer indexer(parser, document->containers);
+        parser.parseDocument(indexer, options);
+
+        JSON root;
+        if (document->containers.empty()) {
+            JSONParser scalarParser(document->text);
+            JSONBuilder builder(root);
+            scalarParser.parseValue(builder, options.maxDepth);
+        } else {
+            root.makeLazy(document, 0);
+        }
+        return root;
+    }
+
+    static JSON parseLazy(const std::string& data, const Options& options = Options()) {
+        return parseLazy(data.data(), data.size(), options);
+    }
+
+    // Returns only the values at the given JSON Pointers (RFC 6901), e.g. "/user/id" or "/items/3/price",
+    // keyed by pointer. Subtrees off the requested paths are skipped by bracket depth without being built or
+    // validated, and parsing stops once every pointer was found. Pointers that do not exist are left out of
+    // the result. Below a duplicated key the first occurrence is used, while a requested object keeps the
+    // last value of a duplicated member just like parse() does.
+    static std::map<std::string, JSON> parsePaths(const char* data, size_t size, const std::vector<std::string>& pointers,
+                                                  const Options& options = Options()) {
+        PathNode root;
+        for (size_t i = 0; i < pointers.size(); ++i)
+            root.add(pointers[i]);
+
+        PathSelection selection(root.wanted);
+        JSONParser parser(data, size);
+        parser.begin(options);
+        parser.select(root, selection, options.maxDepth);
+        return selection.result;
+    }
+
+    static std::map<std::string, JSON> parsePaths(const std::string& data, const std::vector<std::string>& pointers,
+                                                  const Options& options = Options()) {
+        return parsePaths(data.data(), data.size(), pointers, options);
+    }
+
+    // Returns the offset just past the value that starts at pos, after any whitespace, without building it.
+    // Arrays, objects and strings are only scanned for their closing bracket or quote, so their contents are
+    // not validated. Throws if the value is cut off.
+    static size_t skip(const char* data, size_t size, size_t pos = 0) {
+        JSONParser parser(data, size);
+        parser.pos = pos;
+        parser.skipWhitespace();
+        parser.skipValue();
+        return parser.pos;
+    }
+
+    static size_t skip(const std::string& data, size_t pos = 0) {
+        return skip(data.data(), data.size(), pos);
+    }
+
+    typedef JSONValidator::Result Validation;
+
+    // Checks data against the RFC 8259 grammar without building or allocating anything. Unlike parse(), missing
+    // and trailing commas, content after the top level value, control characters in strings and whitespace other
+    // than space, tab, CR and LF are errors. Lone surrogate escapes are rejected as parse() rejects them, numbers
+    // are not checked for range. maxDepth and validateUtf8 are honoured, structuralIndex is ignored.
+    static Validation validate(const char* data, size_t size, const Options& options = Options()) {
+        return JSONValidator::run(data, size, options.maxDepth, options.validateUtf8);
+    }
+
+    static Validation validate(const std::string& data, const Options& options = Options()) {
+        return validate(data.data(), data.size(), options);
+    }
+
+    // Most bytes parse(std::istream&) takes from the stream at once.
+    enum { StreamWindow = 64 * 1024 };
+
+    // Parses the stream as it arrives, taking only what its buffer already holds, so it never waits for more input
+    // than the value needs. Besides the result only one window and a token split across two reads are held in
+    // memory. Works with pipes and other streams that cannot seek. Nothing after the top level value is consumed,
+    // so the next value on the stream can be read by another call. A top level number needs the byte after it or
+    // the end of the stream to complete.
+    static JSON parse(std::istream& in, const Options& options = Options());
+
+    template<typename Handler, typename = typename std::enable_if<IsHandler<Handler>::value>::type>
+    static bool parse(std::istream& in, Handler& handler, const Options& options = Options()) {
+        JSONChunkedParser<Handler> parser(handler, options);
+        std::istream::sentry ready(in, true);
+        std::streambuf* stream = in.rdbuf();
+        std::vector<char> window(StreamWindow);
+        while (ready && !parser.done()) {
+            // sgetc() waits for at least one byte, after that in_avail() is what the buffer holds.
+            if (stream->sgetc() == std::char_traits<char>::eof()) {
+                in.setstate(std::ios::eofbit);
+                break;
+            }
+
+            std::streamsize available = stream->in_avail();
+            size_t count = available > 0 ? static_cast<size_t>(available) : 1;
+            if (count > window.size())
+                count = window.size();
+            count = static_cast<size_t>(stream->sgetn(window.data(), static_cast<std::streamsize>(count)));
+            parser.feed(window.data(), count);
+
+            // The bytes after the value were taken from the buffer just now, so they can all be put back.
+            for (size_t i = parser.consumed(); i < count; ++i)
+                stream->sungetc();
+        }
+
+        parser.finish();
+        return !parser.stopped();
+    }
+
+#ifndef JSON_DISABLE_THREADS
+    // Parses a document whose top level value is an array by splitting its elements across threads (0 uses
+    // std::thread::hardware_concurrency()). Element boundaries come from a pass of the SIMD structural indexer.
+    // The result, including any error, is identical to parse(), malformed input falls back to it.
+    static JSON parseParallel(const char* data, size_t size, const Options& options = Options(), size_t threads = 0) {
+        ElementScanner elements(data);
+        JSONStructuralIndex::scan(data, size, elements);
+        if (!elements.finished || elements.malformed || elements.starts.empty() || options.maxDepth == 0)
+            return parse(data, size, options);
+
+        if (options.validateUtf8) {
+            size_t invalid = JSONUtf8::validate(data, size);
+            if (invalid != size) {
+                JSONParser parser(data, size);
+                parser.pos = invalid;
+                parser.throwError("Invalid UTF-8 in JSON");
+            }
+        }
+
+        if (threads == 0)
+            threads = std::thread::hardware_concurrency();
+        if (threads == 0)
+            threads = 1;
+
+        // Cut the elements into ranges of roughly equal size, a few per thread to even out the load.
+        std::vector<size_t> ranges(1, 0);
+        size_t target = size / (threads * 4) + 1;
+        size_t rangeStart = elements.starts[0];
+        for (size_t i = 0; i < elements.starts.size(); ++i) {
+            if (elements.stops[i] - rangeStart >= target) {
+                ranges.push_back(i + 1);
+                rangeStart = elements.stops[i];
+            }
+        }
+        if (ranges.back() != elements.starts.size())
+            ranges.push_back(elements.starts.size());
+
+        JSON root;
+        JSON::ArrayType& array = root.makeArray();
+        array.resize(elements.starts.size());
+
+        std::atomic<size_t> nextRange(0);
+        std::atomic<bool> failed(false);
+        std::vector<std::thread> workers;
+        size_t workerCount = threads < ranges.size() - 1 ? threads : ranges.size() - 1;
+        workers.reserve(workerCount);
+        try {
+            for (size_t t = 0; t < workerCount; ++t)
+                workers.push_back(std::thread([&] {
+                    JSONParser parser(data, size);
+                    try {
+                        size_t r;
+                        while (!failed && (r = nextRange++) < ranges.size() - 1) {
+                            for (size_t i = ranges[r]; i < ranges[r + 1] && !failed; ++i) {
+                                parser.pos = elements.starts[i];
+                                JSONBuilder builder(array[i]);
+                                parser.parseValue(builder, options.maxDepth - 1);
+                                parser.skipWhitespace();
+                                if (parser.pos != elements.stops[i])
+                                    failed = true;
+                            }
+                        }
+                    } catch (...) {
+                        failed = true;
+                    }
+                }));
+        } catch (...) {
+            // A thread could not be started, stop and join the ones that were.
+            failed = true;
+            for (size_t t = 0; t < workers.size(); ++t)
+                workers[t].join();
+            throw;
+        }
+
+        for (size_t t = 0; t < workers.size(); ++t)
+            workers[t].join();
+
+        // Let the sequential parser produce the exact error.
+        if (failed)
+            return parse(data, size, options);
+        return root;
+    }
+
+    static JSON parseParallel(const std::string& data, const Options& options = Options(), size_t threads = 0) {
+        return parseParallel(data.data(), data.size(), options, threads);
+    }
+#endif
+
+    // Maps the file and parses straight from the mapping, see JSONMappedFile::Flags.
+    static JSON parseFile(const std::string& path, int flags = JSONMappedFile::Sequential,
+                          const Options& options = Options()) {
+        JSONMappedFile file(path, flags);
+        return parse(file.data(), file.size(), options);
+    }
+
+    // Points a long lived parser at the next message. The input buffer, string scratch, bracket stack and
+    // builder stack keep their capacity, so parsing many small messages does not reallocate them.
+    void reset(const char* data, size_t size) {
+        bind(data, size);
+        insitu = nullptr;
+    }
+
+    void reset(const std::string& data) {
+        reset(data.data(), data.size());
+    }
+
+    void reset(std::string&&) = delete;
+
+    // Like reset(data, size) for in situ parsing, see parseInsitu().
+    void resetInsitu(char* data, size_t size) {
+        bind(data, size);
+        insitu = data;
+    }
+
+    // Reads the whole stream into the parser's own buffer.
+    void reset(std::istream& in) {
+        buffer.clear();
+        char chunk[4096];
+        while (in.read(chunk, sizeof(chunk)) || in.gcount() > 0)
+            buffer.append(chunk, static_cast<size_t>(in.gcount()));
+        reset(buffer.data(), buffer.size());
+    }
+
+    // Parses the input given to reset() or the constructor. Reading into an existing value reuses its
+    // top level container.
+    JSON read(const Options& options = Options()) {
+        JSON root;
+        read(root, options);
+        return root;
+    }
+
+    void read(JSON& root, const Options& options = Options()) {
+        builder.reset(root);
+        parseDocument(builder, options);
+    }
+
+    template<typename Handler, typename = typename std::enable_if<IsHandler<Handler>::value>::type>
+    bool read(Handler& handler, const Options& options = Options()) {
+        return parseDocument(handler, options);
+    }
+
+
+private:
+    friend class JSONReader;
+    friend class JSONLinesReader;
+    friend class JSON;
+    template<typename Handler>
+    friend class JSONChunkedParser;
+
+    // Visitor for JSONStructuralIndex::scan that records where each element of a top level array starts and
+    // where the next token after it is. Only bracket depth is tracked, the elements are validated when parsed.
+    struct ElementScanner {
+        explicit ElementScanner(const char* data)
+        : data(data), depth(0), open(false), started(false), finished(false), malformed(false) {}
+
+        void block(size_t base, uint64_t bits, uint64_t) {
+            while (bits && !finished) {
+                size_t offset = base + JSONStructuralIndex::ctz(bits);
+                visit(offset, data[offset]);
+                bits &= bits - 1;
+            }
+        }
+
+        void visit(size_t offset, char ch) {
+            if (!started) {
+                started = true;
+                finished = ch != '[';
+                depth = 1;
+                return;
+            }
+
+            if (depth > 1) {
+                if (ch == '{' || ch == '[')
+                    depth++;
+                else if (ch == '}' || ch == ']')
+                    depth--;
+                return;
+            }
+
+            // At depth one any token ends the previous element, normally ',' or ']' but also a value after a
+            // missing comma.
+            if (ch == ',' && !open) {
+                malformed = true;
+                finished = true;
+                return;
+            }
+
+            if (open)
+                stops.push_back(offset);
+            open = false;
+            if (ch == ']') {
+                finished = true;
+            } else if (ch != ',') {
+                starts.push_back(offset);
+                open = true;
+                if (ch == '{' || ch == '[')
+                    depth++;
+            }
+        }
+
+        const char* data;
+        size_t depth;
+        bool open;     // An element was started and its end not seen yet.
+        bool started;
+        bool finished; // Saw the closing bracket of the top level array, or the top level is not an array.
+        bool malformed;
+        std::vector<size_t> starts;
+        std::vector<size_t> stops;
+    };
+
+    // Records where every array and object starts and ends while the document is validated.
+    struct LazyIndexer : JSONHandler {
+        LazyIndexer(const JSONParser& parser, std::vector<JSONLazyDocument::Container>& containers)
+        : parser(parser), containers(containers) {}
+
+        bool startObject() { return open(); }
+        bool startArray() { return open(); }
+        bool endObject() { return close(); }
+        bool endArray() { return close(); }
+
+        bool open() {
+            JSONLazyDocument::Container container = { parser.pos - 1, 0, 0 };
+            stack.push_back(containers.size());
+            containers.push_back(container);
+            return true;
+        }
+
+        bool close() {
+            JSONLazyDocument::Container& container = containers[stack.back()];
+            container.end = parser.pos - 1;
+            container.descendants = containers.size() - stack.back() - 1;
+            stack.pop_back();
+            return true;
+        }
+
+        const JSONParser& parser;
+        std::vector<JSONLazyDocument::Container>& containers;
+        std::vector<size_t> stack;
+    };
+
+    // Trie of the reference tokens of the pointers given to parsePaths().
+    struct PathNode {
+        const std::string* pointer; // Pointer that ends here, if any.
+        size_t wanted;              // Pointers ending here or below.
+        size_t index;               // Token as an array index, SIZE_MAX if it is not one.
+        bool visited;               // Set once the value was reached, later duplicate keys are skipped.
+        std::map<std::string, PathNode> children;
+        std::map<size_t, PathNode*> indexes; // Children whose token is an array index, by index.
+
+        PathNode() : pointer(nullptr), wanted(0), index(SIZE_MAX), visited(false) {}
+
+        void add(const std::string& path) {
+            if (!path.empty() && path[0] != '/')
+                throw std::runtime_error("Invalid JSON Pointer \"" + path + "\"");
+
+            std::vector<PathNode*> nodes(1, this);
+            size_t start = 1;
+            while (start <= path.size()) {
+                size_t end = path.find('/', start);
+                if (end == std::string::npos)
+                    end = path.size();
+
+                std::string token;
+                for (size_t i = start; i < end; ++i) {
+                    if (path[i] == '~' && i + 1 < end && (path[i + 1] == '0' || path[i + 1] == '1')) {
+                        token += path[++i] == '0' ? '~' : '/';
+                    } else if (path[i] == '~') {
+                        throw std::runtime_error("Invalid JSON Pointer \"" + path + "\"");
+                    } else {
+                        token += path[i];
+                    }
+                }
+
+                PathNode& child = nodes.back()->children[token];
+                child.index = arrayIndex(token);
+                if (child.index != SIZE_MAX)
+                    nodes.back()->indexes[child.index] = &child;
+                nodes.push_back(&child);
+                start = end + 1;
+            }
+
+            if (nodes.back()->pointer)
+                return;
+            nodes.back()->pointer = &path;
+            for (size_t i = 0; i < nodes.size(); ++i)
+                nodes[i]->wanted++;
+        }
+
+        // Digits without a leading zero, as RFC 6901 requires.
+        static size_t arrayIndex(const std::string& token) {
+            if (token.empty() || token.size() > 18 || (token[0] == '0' && token.size() > 1))
+                return SIZE_MAX;
+            size_t index = 0;
+            for (size_t i = 0; i < token.size(); ++i) {
+                if (token[i] < '0' || token[i] > '9')
+                    return SIZE_MAX;
+                index = index * 10 + (token[i] - '0');
+            }
+            return index;
+        }
+    };
+
+    struct PathSelection {
+        explicit PathSelection(size_t missing) : missing(missing) {}
+
+        size_t missing; // Pointers not found yet, parsing stops when this reaches zero.
+        std::map<std::string, JSON> result;
+
+        // Records the pointers below node that exist inside value, which was built in full. missing drops by one
+        // for every pointer recorded here, nested calls included.
+        size_t collect(const PathNode& node, const JSON& value) {
+            size_t found = 0;
+            for (std::map<std::string, PathNode>::const_iterator it = node.children.begin(); it != node.children.end(); ++it) {
+                const JSON* child = nullptr;
+                if (value.type == JSON::Object) {
+                    JSON::ObjectType::const_iterator member = value.object->find(JSON::StringType(it->first.data(), it->first.size()));
+                    if (member != value.object->end())
+                        child = &member->second;
+                } else if (value.type == JSON::Array && it->second.index < value.array->size()) {
+                    child = &(*value.array)[it->second.index];
+                }
+
+                if (!child)
+                    continue;
+                if (it->second.pointer) {
+                    result[*it->second.pointer] = *child;
+                    found++;
+                    missing--;
+                }
+                found += collect(it->second, *child);
+            }
+            return found;
+        }
+    };
+
+    // Walks the value at pos along node, returns the number of pointers found at or below it. maxDepth is the
+    // nesting still allowed here.
+    size_t select(PathNode& node, PathSelection& selection, size_t maxDepth) {
+        node.visited = true;
+        skipWhitespace();
+        if (node.pointer) {
+            JSON& value = selection.result[*node.pointer];
+            JSONBuilder builder(value);
+            parseValue(builder, maxDepth);
+            selection.missing--;
+            return selection.collect(node, value) + 1;
+        }
+
+        char open = peek();
+        if (open != '{' && open != '[') {
+            skipValue();
+            return 0;
+        }
+
+        if (maxDepth == 0)
+            throwError("Maximum nesting depth exceeded in JSON");
+        advance();
+
+        char close = open == '{' ? '}' : ']';
+        size_t found = 0;
+        size_t index = 0;
+        for (;; ++index) {
+            skipWhitespace();
+            if (peek() == ',') {
+                advance();
+                skipWhitespace();
+            }
+            if (peek() == close) {
+                advance();
+                break;
+            }
+
+            PathNode* child = nullptr;
+            if (open == '{') {
+                const char* str;
+                size_t length;
+                parseString(str, length);
+                skipWhitespace();
+                if (peek() != ':')
+                    throwError("Expected ':' in JSON object");
+                advance();
+
+                std::map<std::string, PathNode>::iterator it = node.children.find(std::string(str, length));
+                if (it != node.children.end())
+                    child = &it->second;
+            } else {
+                std::map<size_t, PathNode*>::iterator it = node.indexes.find(index);
+                if (it != node.indexes.end())
+                    child = it->second;
+            }
+
+            if (child && !child->visited) {
+                found += select(*child, selection, maxDepth - 1);
+                if (selection.missing == 0)
+                    return found;
+                if (found == node.wanted) {
+                    skipContainer();
+                    break;
+                }
+            } else {
+                skipWhitespace();
+                skipValue();
+            }
+        }
+
+        return found;
+    }
+
+    // Moves past the value at pos. Arrays, objects and strings are only scanned for their end, the other
+    // scalars are parsed.
+    void skipValue() {
+        char ch = peek();
+        if (ch == '{' || ch == '[') {
+            advance();
+            skipContainer();
+        } else if (ch == '"') {
+            advance();
+            skipString();
+        } else {
+            JSONHandler ignore;
+            parseValue(ignore, 1);
+        }
+    }
+
+    // Builds one level of the lazy container ref points to into value, nested containers become Lazy values
+    // themselves.
+    static void materialize(JSON& value, const JSONLazyRef& ref) {
+        const std::shared_ptr<const JSONLazyDocument>& document = ref.document;
+        size_t index = ref.container;
+        const JSONLazyDocument::Container& container = document->containers[index];
+
+        JSONParser parser(document->text);
+        parser.pos = container.start + 1;
+        bool isObject = document->text[container.start] == '{';
+        if (isObject)
+            value.makeObject();
+        else
+            value.makeArray();
+
+        size_t child = index + 1;
+        for (;;) {
+            parser.skipWhitespace();
+            if (parser.peek() == ',') {
+                parser.advance();
+                parser.skipWhitespace();
+            }
+            if (parser.pos >= container.end)
+                return;
+
+            JSON* slot;
+            if (isObject) {
+                const char* str;
+                size_t length;
+                parser.parseString(str, length);
+                slot = &(*value.object)[JSON::StringType(str, length)];
+                parser.skipWhitespace();
+                parser.advance();
+                parser.skipWhitespace();
+            } else {
+                value.array->push_back(JSON());
+                slot = &value.array->back();
+            }
+
+            char ch = parser.peek();
+            if (ch == '{' || ch == '[') {
+                slot->makeLazy(document, child);
+                parser.pos = document->containers[child].end + 1;
+                child += document->containers[child].descendants + 1;
+            } else {
+                JSONBuilder builder(*slot);
+                parser.parseValue(builder, 1);
+            }
+        }
+    }
+
+    std::string buffer;
+    const char* data;
+    size_t size;
+    size_t pos;
+    std::vector<char> stack; // Opening bracket of every open array and object, innermost last.
+    std::unique_ptr<uint32_t[]> structurals; // Token offsets for Options::structuralIndex, left uninitialized.
+    size_t structuralCapacity;
+    std::string text;        // Decoded strings that contained escapes.
+    bool streaming;          // Input is one token of a larger stream, errors report the stream offset.
+    size_t streamOffset;
+    char* insitu;            // Writable alias of data, escapes are decoded in place.
+    JSONBuilder builder;     // Kept for read(JSON&).
+
+    JSON parseDocument(const Options& options) {
+        JSON root;
+        JSONBuilder builder(root);
+        parseDocument(builder, options);
+        return root;
+    }
+
+    template<typename Handler>
+    bool parseDocument(Handler& handler, const Options& options) {
+        begin(options);
+#if defined(JSON_HAS_AVX2) || defined(JSON_HAS_SSE2)
+        // Classifying blocks without vector compares is slower than the byte by byte parser.
+        if (options.structuralIndex && size < UINT32_MAX) {
+            if (structuralCapacity < size + 65) {
+                structurals.reset(new uint32_t[size + 65]);
+                structuralCapacity = size + 65;
+            }
+            JSONStructuralIndex::build(data, size, structurals.get());
+            return parseIndexed(handler, options.maxDepth);
+        }
+#endif
+        return parseValue(handler, options.maxDepth);
+    }
+
+    void begin(const Options& options) {
+        if (size == 0)
+            throw std::runtime_error("Empty JSON file");
+
+        if (options.validateUtf8) {
+            size_t invalid = JSONUtf8::validate(data, size);
+            if (invalid != size) {
+                pos = invalid;
+                throwError("Invalid UTF-8 in JSON");
+            }
+        }
+    }
+
+    // Points the parser at new input, keeping the capacity of its stack and scratch buffers.
+    void bind(const char* data, size_t size) {
+        this->data = data;
+        this->size = size;
+        pos = 0;
+    }
+
+    // Input is not required to be null terminated, reading past the end yields '\0'.
+    char peek() const {
+        return pos < size ? data[pos] : '\0';
+    }
+
+    bool match(const char* literal, size_t length) const {
+        return size - pos >= length && memcmp(data + pos, literal, length) == 0;
+    }
+
+    void advance(size_t count = 1) {
+        pos += count;
+    }
+
+    void skipWhitespace() {
+        while (pos < size && isspace(static_cast<unsigned char>(data[pos]))) {
+            advance();
+        }
+    }
+
+    [[noreturn]] void throwError(const std::string& message) const {
+        // In situ decoding may have turned escapes into newlines, so lines can no longer be counted.
+        if (streaming || insitu) {
+            std::ostringstream oss;
+            oss << message << " at offset " << streamOffset + pos;
+            throw std::runtime_error(oss.str());
+        }
+
+        // Line and column are only needed here, so they are recovered from pos instead of tracked per byte.
+        size_t end = pos < size ? pos : size;
+        int line = 1;
+        int col = 1;
+        for (size_t i = 0; i < end; ++i) {
+            if (data[i] == '\n') {
+                line++;
+                col = 1;
+            } else {
+                col++;
+            }
+        }
+
+        std::ostringstream oss;
+
+        oss << message << " at line " << line << ", column " << col;
+        throw std::runtime_error(oss.str());
+    }
+
+    // Non-recursive: open containers are tracked on an explicit stack instead of the native one.
+    template<typename Handler>
+    bool parseValue(Handler& handler, size_t maxDepth) {
+        stack.clear();
+        for (;;) {
+            skipWhitespace();
+            char ch = peek();
+            if (ch == '{' || ch == '[') {
+                if (stack.size() >= maxDepth)
+                    throwError("Maximum nesting depth exceeded in JSON");
+
+                advance();
+                if (!(ch == '{' ? handler.startObject() : handler.startArray()))
+                    return false;
+                stack.push_back(ch);
+                skipWhitespace();
+                if (peek() != (ch == '{' ? '}' : ']')) {
+                    if (ch == '{' && !parseKey(handler))
+                        return false;
+                    continue;
+                }
+
+                advance();
+                stack.pop_back();
+                if (!(ch == '{' ? handler.endObject() : handler.endArray()))
+                    return false;
+            } else if (ch == '"') {
+                const char* str;
+                size_t length;
+                parseString(str, length);
+                if (!handler.string(str, length))
+                    return false;
+            } else if (ch == 't' || ch == 'f') {
+                if (!handler.boolean(parseBoolean()))
+                    return false;
+            } else if (ch == 'n') {
+                parseNull();
+                if (!handler.null())
+                    return false;
+            } else if (ch == '-' || (ch >= '0' && ch <= '9')) {
+                if (!parseNumber(handler))
+                    return false;
+            } else {
+                throwError("Unexpected character in JSON");
+            }
+
+            // The value is complete, close finished containers and move on to the next member.
+            for (;;) {
+                if (stack.empty())
+                    return true;
+
+                char open = stack.back();
+                skipWhitespace();
+                if (peek() == ',') {
+                    advance();
+                    skipWhitespace();
+                }
+
+                if (peek() == (open == '{' ? '}' : ']')) {
+                    advance();
+                    stack.pop_back();
+                    if (!(open == '{' ? handler.endObject() : handler.endArray()))
+                        return false;
+                } else {
+                    if (open == '{' && !parseKey(handler))
+                        return false;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Stage two of Options::structuralIndex, parseValue() driven by the token offsets in structurals. The index
+    // ends with size, where peek() yields '\0', so every read past the last token fails as parseValue() would.
+    template<typename Handler>
+    bool parseIndexed(Handler& handler, size_t maxDepth) {
+        stack.clear();
+        size_t next = 0;
+        for (;;) {
+            char ch = token(next++);
+            if (ch == '{' || ch == '[') {
+                if (stack.size() >= maxDepth)
+                    throwError("Maximum nesting depth exceeded in JSON");
+
+                if (!(ch == '{' ? handler.startObject() : handler.startArray()))
+                    return false;
+                stack.push_back(ch);
+                if (token(next) != (ch == '{' ? '}' : ']')) {
+                    if (ch == '{' && !parseIndexedKey(handler, next))
+                        return false;
+                    continue;
+                }
+
+                next++;
+                stack.pop_back();
+                if (!(ch == '{' ? handler.endObject() : handler.endArray()))
+                    return false;
+            } else if (ch == '"') {
+                const char* str;
+                size_t length;
+                parseIndexedString(next, str, length);
+                if (!handler.string(str, length))
+                    return false;
+            } else {
+                if (ch == 't' || ch == 'f') {
+                    if (!handler.boolean(parseBoolean()))
+                        return false;
+                } else if (ch == 'n') {
+                    parseNull();
+                    if (!handler.null())
+                        return false;
+                } else if (ch == '-' || (ch >= '0' && ch <= '9')) {
+                    if (!parseNumber(handler))
+                        return false;
+                } else {
+                    throwError("Unexpected character in JSON");
+                }
+
+                // Only the first byte of a run of scalar characters is indexed. When this scalar ended inside the
+                // run, e.g. "truefalse", the rest takes over its slot to be read as the next token.
+                if (pos != structurals[next] && !isspace(static_cast<unsigned char>(peek())))
+                    structurals[--next] = static_cast<uint32_t>(pos);
+            }
+
+            // The value is complete, close finished containers and move on to the next member.
+            for (;;) {
+                if (stack.empty())
+                    return true;
+
+                char open = stack.back();
+                if (token(next) == ',')
+                    token(++next);
+
+                if (peek() == (open == '{' ? '}' : ']')) {
+                    next++;
+                    stack.pop_back();
+                    if (!(open == '{' ? handler.endObject() : handler.endArray()))
+                        return false;
+                } else {
+                    if (open == '{' && !parseIndexedKey(handler, next))
+                        return false;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Moves pos to the token at index i of structurals and returns its character.
+    char token(size_t i) {
+        pos = structurals[i];
+        return peek();
+    }
+
+    template<typename Handler>
+    bool parseIndexedKey(Handler& handler, size_t& next) {
+        if (token(next) != '"')
+            throwError("Expected string in JSON");
+
+        const char* str;
+        size_t length;
+        parseIndexedString(++next, str, length);
+        if (!handler.key(str, length))
+            return false;
+
+        if (token(next) != ':')
+            throwError("Expected ':' in JSON object");
+        next++;
+        return true;
+    }
+
+    // pos is on an opening quote and next on the index entry after it, which is the closing quote. Strings without
+    // escapes are returned without looking at them byte by byte. The rest, and unterminated strings, whose error
+    // may come from an escape first, go through parseString().
+    void parseIndexedString(size_t& next, const char*& str, size_t& length) {
+        size_t end = structurals[next];
+        if (end != size) {
+            next++;
+            const char* start = data + pos + 1;
+            if (!memchr(start, '\\', end - pos - 1)) {
+                str = start;
+                length = end - pos - 1;
+                pos = end + 1;
+                return;
+            }
+        }
+
+        parseString(str, length);
+    }
+
+    template<typename Handler>
+    bool parseKey(Handler& handler) {
+        const char* str;
+        size_t length;
+        parseString(str, length);
+        if (!handler.key(str, length))
+            return false;
+
+        skipWhitespace();
+        if (peek() != ':')
+            throwError("Expected ':' in JSON object");
+        advance();
+        return true;
+    }
+
+    // Moves past the container whose opening bracket was already consumed, tracking only bracket depth and
+    // string boundaries with JSONStructuralIndex::skip(). Nothing inside is validated.
+    void skipContainer(size_t depth = 1) {
+        size_t end = JSONStructuralIndex::skip(data, size, pos, depth);
+        if (end == SIZE_MAX) {
+            pos = size;
+            throwError("Unterminated array or object in JSON");
+        }
+
+        pos = end;
+    }
+
+    // Moves past the string whose opening quote was already consumed, without decoding it.
+    void skipString() {
+        for (;;) {
+            const char* quote = static_cast<const char*>(memchr(data + pos, '"', size - pos));
+            if (!quote) {
+                pos = size;
+                throwError("Unterminated string in JSON");
+            }
+
+            pos = quote - data + 1;
+            size_t backslashes = 0;
+            while (quote - backslashes > data && quote[-1 - static_cast<ptrdiff_t>(backslashes)] == '\\')
+                backslashes++;
+            if (backslashes % 2 == 0)
+                return;
+        }
+    }
+
+    // Escape free strings are returned as a view into the input, the rest are decoded into text.
+    void parseString(const char*& str, size_t& length) {
+        if (peek() != '"')
+            throwError("Expected string in JSON");
+
+        advance();
+        size_t start = pos;
+        while (pos < size && data[pos] != '"' && data[pos] != '\\')
+            pos++;
+
+        if (pos >= size)
+            throwError("Unterminated string in JSON");
+
+        if (data[pos] == '"') {
+            str = data + start;
+            length = pos - start;
+            advance();
+            return;
+        }
+
+        // pos is on a backslash at the top of both loops, the bytes between escapes are copied as whole runs.
+        if (insitu) {
+            // Escapes are never shorter than what they decode to, so the output can trail behind the input.
+            char* out = insitu + pos;
+            for (;;) {
+                advance();
+                out += unescape(out);
+                advance();
+                size_t run = pos;
+                while (pos < size && data[pos] != '"' && data[pos] != '\\')
+                    pos++;
+                if (pos >= size)
+                    throwError("Unterminated string in JSON");
+
+                memmove(out, data + run, pos - run);
+                out += pos - run;
+                if (data[pos] == '"')
+                    break;
+            }
+            advance();
+            str = insitu + start;
+            length = out - str;
+            return;
+        }
+
+        text.assign(data + start, pos - start);
+        for (;;) {
+            char decoded[4];
+            advance();
+            text.append(decoded, unescape(decoded));
+            advance();
+            size_t run = pos;
+            while (pos < size && data[pos] != '"' && data[pos] != '\\')
+                pos++;
+            if (pos >= size)
+                throwError("Unterminated string in JSON");
+
+            text.append(data + run, pos - run);
+            if (data[pos] == '"')
+                break;
+        }
+        advance();
+        str = text.data();
+        length = text.size();
+    }
+
+    // Decodes the escape whose character is at pos into out, which has room for 4 bytes, and returns the number
+    // of bytes written. pos is left on the last character of the escape.
+    size_t unescape(char* out) {
+        switch (peek()) {
+            case '\\': *out = '\\'; return 1;
+            case '"': *out = '"'; return 1;
+            case '/': *out = '/'; return 1;
+            case 'b': *out = '\b'; return 1;
+            case 'f': *out = '\f'; return 1;
+            case 'n': *out = '\n'; return 1;
+            case 'r': *out = '\r'; return 1;
+            case 't': *out = '\t'; return 1;
+            case 'u': break;
+            default: throwError("Invalid escape character in string");
+        }
+
+        uint32_t code = parseHex();
+        if (code >= 0xDC00 && code <= 0xDFFF)
+            throwError("Unpaired surrogate in string");
+        if (code >= 0xD800 && code <= 0xDBFF) {
+            advance();
+            if (!match("\\u", 2))
+                throwError("Unpaired surrogate in string");
+            advance();
+            uint32_t low = parseHex();
+            if (low < 0xDC00 || low > 0xDFFF)
+                throwError("Unpaired surrogate in string");
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        }
+
+        if (code < 0x80) {
+            out[0] = static_cast<char>(code);
+            return 1;
+        }
+        if (code < 0x800) {
+            out[0] = static_cast<char>(0xC0 | (code >> 6));
+            out[1] = static_cast<char>(0x80 | (code & 0x3F));
+            return 2;
+        }
+        if (code < 0x10000) {
+            out[0] = static_cast<char>(0xE0 | (code >> 12));
+            out[1] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out[2] = static_cast<char>(0x80 | (code & 0x3F));
+            return 3;
+        }
+        out[0] = static_cast<char>(0xF0 | (code >> 18));
+        out[1] = static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        out[2] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out[3] = static_cast<char>(0x80 | (code & 0x3F));
+        return 4;
+    }
+
+    // Reads the 4 hex digits after the 'u' at pos.
+    uint32_t parseHex() {
+        uint32_t code = 0;
+        for (int i = 0; i < 4; ++i) {
+            advance();
+            char ch = peek();
+            uint32_t digit;
+            if (ch >= '0' && ch <= '9')
+                digit = ch - '0';
+            else if (ch >= 'a' && ch <= 'f')
+                digit = ch - 'a' + 10;
+            else if (ch >= 'A' && ch <= 'F')
+                digit = ch - 'A' + 10;
+            else
+                throwError("Invalid unicode escape in string");
+            code = (code << 4) | digit;
+        }
+        return code;
+    }
+
+    bool parseBoolean() {
+        if (match("true", 4)) {
+            advance(4);
+            return true;
+        } else if (match("false", 5)) {
+            advance(5);
+            return false;
+        } else {
+            throwError("Unexpected boolean value in JSON");
+        }
+    }
+
+    void parseNull() {
+        if (!match("null", 4))
+            throwError("Unexpected null value in JSON");
+        advance(4);
+    }
+
+    template<typename Handler>
+    bool parseNumber(Handler& handler) {
+        JSONDecimal decimal;
+        decimal.mantissa = 0;
+        decimal.exponent = 0;
+        decimal.negative = false;
+        decimal.truncated = false;
+        decimal.begin = data + pos;
+
+        if (peek() == '-') {
+            decimal.negative = true;
+            advance();
+        }
+
+        char ch = peek();
+        if (ch < '0' || ch > '9')
+            throwError("Invalid number in JSON");
+
+        int digits = 0;
+        uint64_t wide = 0; // A 20 digit integer can still fit in uint64_t.
+        bool wideValid = false;
+        if (ch == '0') {
+            advance();
+            // Leading zeroes are not allowed, ending the number here would split "0123" into two values.
+            if ((ch = peek()) >= '0' && ch <= '9')
+                throwError("Invalid number in JSON");
+        } else {
+            while ((ch = peek()) >= '0' && ch <= '9') {
+                if (digits < 19) {
+                    decimal.mantissa = decimal.mantissa * 10 + (ch - '0');
+                    digits++;
+                } else {
+                    uint64_t digit = static_cast<uint64_t>(ch - '0');
+                    wideValid = !decimal.truncated && decimal.mantissa <= (UINT64_MAX - digit) / 10;
+                    wide = decimal.mantissa * 10 + digit;
+                    decimal.truncated = true;
+                    decimal.exponent++;
+                }
+                advance();
+            }
+        }
+
+        bool isInteger = true;
+        if (peek() == '.') {
+            isInteger = false;
             advance();
+            ch = peek();
+            if (ch < '0' || ch > '9')
+                throwError("Expected digit after '.' in JSON number");
+
+            while ((ch = peek()) >= '0' && ch <= '9') {
+                if (digits < 19) {
+                    decimal.mantissa = decimal.mantissa * 10 + (ch - '0');
+                    decimal.exponent--;
+                    if (decimal.mantissa != 0)
+                        digits++;
+                } else {
+                    decimal.truncated = true;
+                }
+                advance();
+            }
         }
-        if (data[pos] == '.') {
+
+        ch = peek();
+        if (ch == 'e' || ch == 'E') {
+            isInteger = false;
             advance();
-            while (data[pos] >= '0' && data[pos] <= '9') {
+            bool negativeExponent = false;
+            if (peek() == '+' || peek() == '-') {
+                negativeExponent = peek() == '-';
+                advance();
+            }
+
+            ch = peek();
+            if (ch < '0' || ch > '9')
+                throwError("Expected digit in JSON number exponent");
+
+            int64_t exponent = 0;
+            while ((ch = peek()) >= '0' && ch <= '9') {
+                if (exponent < 100000)
+                    exponent = exponent * 10 + (ch - '0');
                 advance();
             }
-            return JSON(std::stod(std::string(&data[start], pos - start)));
+            decimal.exponent += negativeExponent ? -exponent : exponent;
+        }
+
+        decimal.end = data + pos;
+        if (isInteger && (!decimal.truncated || wideValid)) {
+            uint64_t value = decimal.truncated ? wide : decimal.mantissa;
+            if (!decimal.negative)
+                return value > INT64_MAX ? handler.unsignedInteger(value) : handler.integer(static_cast<int64_t>(value));
+            if (value <= 1ULL << 63)
+                return handler.integer(static_cast<int64_t>(0 - value));
+        }
+
+        double value;
+        if (!decimal.toDouble(value))
+            throwError("Number out of range in JSON");
+
+        return handler.number(value);
+    }
+};
+
+inline const JSON& JSON::lazyValue() const {
+    JSONLazyRef& ref = *lazy;
+#ifndef JSON_DISABLE_THREADS
+    std::call_once(ref.built, [&ref] {
+        ref.value.reset(new JSON());
+        JSONParser::materialize(*ref.value, ref);
+    });
+#else
+    if (!ref.value) {
+        ref.value.reset(new JSON());
+        JSONParser::materialize(*ref.value, ref);
+    }
+#endif
+    return *ref.value;
+}
+
+// A container already built by a const read is taken over instead of being parsed again.
+inline void JSON::materializeLazy() {
+    JSON value;
+    if (lazy->value)
+        value = std::move(*lazy->value);
+    else
+        JSONParser::materialize(value, *lazy);
+
+    clear();
+    type = value.type;
+    take(value);
+}
+
+// Document whose strings, arrays and objects are allocated from a JSONArena. Reparsing or destroying it hands the
+// arena blocks back without visiting the nodes, so the tree is read only. Copy root() into a JSON to modify it.
+class JSONDocument {
+public:
+    JSONDocument() {}
+    explicit JSONDocument(size_t blockSize) : arena(blockSize) {}
+
+    JSONDocument(const JSONDocument&) = delete;
+    JSONDocument& operator=(const JSONDocument&) = delete;
+
+    // Replaces the current tree, the newest arena block is reused for the new one. The parser and builder
+    // are kept as well, so reparsing small messages allocates nothing once the block is large enough.
+    const JSON& parse(const char* data, size_t size, const JSONParser::Options& options = JSONParser::Options()) {
+        value = JSON();
+        arena.reset();
+        try {
+            builder.reset(value, &arena);
+            parser.reset(data, size);
+            parser.read(builder, options);
+        } catch (...) {
+            value = JSON();
+            throw;
+        }
+        return value;
+    }
+
+    const JSON& parse(const std::string& data, const JSONParser::Options& options = JSONParser::Options()) {
+        return parse(data.data(), data.size(), options);
+    }
+
+    // Unescapes strings inside buffer and makes string values point at them, only keys are copied into the
+    // arena. The buffer is modified and has to outlive the tree.
+    const JSON& parseInsitu(char* buffer, size_t size, const JSONParser::Options& options = JSONParser::Options()) {
+        value = JSON();
+        arena.reset();
+        try {
+            builder.reset(value, &arena, true);
+            parser.resetInsitu(buffer, size);
+            parser.read(builder, options);
+        } catch (...) {
+            value = JSON();
+            throw;
+        }
+        return value;
+    }
+
+    const JSON& parseFile(const std::string& path, int flags = JSONMappedFile::Sequential,
+                          const JSONParser::Options& options = JSONParser::Options()) {
+        JSONMappedFile file(path, flags);
+        return parse(file.data(), file.size(), options);
+    }
+
+    const JSON& root() const { return value; }
+
+    // Bytes held by the arena.
+    size_t capacity() const { return arena.capacity(); }
+
+private:
+    JSONArena arena; // Declared first so it outlives value.
+    JSON value;
+    JSONParser parser;
+    JSONBuilder builder;
+};
+
+// Pull parser, hands out one token per next() call so callers can stop as soon as they have what they need.
+// String and key data point into the input or into reader scratch and stay valid until the next call.
+class JSONReader {
+public:
+    enum Token {
+        End,
+        StartObject,
+        EndObject,
+        StartArray,
+        EndArray,
+        Key,
+        String,
+        Integer,
+        UnsignedInteger,
+        Double,
+        Boolean,
+        Null
+    };
+
+    JSONReader(const char* data, size_t size, const JSONParser::Options& options = JSONParser::Options())
+    : parser(data, size), maxDepth(options.maxDepth), state(BeforeValue), current(End), str(nullptr), length(0) {
+        parser.begin(options);
+        parser.stack.clear();
+    }
+
+    JSONReader(const std::string& data, const JSONParser::Options& options = JSONParser::Options())
+    : JSONReader(data.data(), data.size(), options) {}
+    // The reader keeps a view of data, a temporary would be gone before the first next().
+    JSONReader(std::string&&, const JSONParser::Options& = JSONParser::Options()) = delete;
+
+    JSONReader(const JSONReader&) = delete;
+    JSONReader& operator=(const JSONReader&) = delete;
+
+    // Advances to the next token, returns End once the top level value is complete.
+    Token next() {
+        std::vector<char>& stack = parser.stack;
+        if (state == Finished)
+            return current = End;
+
+        if (state != BeforeValue) {
+            if (stack.empty()) {
+                state = Finished;
+                return current = End;
+            }
+
+            char open = stack.back();
+            parser.skipWhitespace();
+            if (state == AfterValue && parser.peek() == ',') {
+                parser.advance();
+                parser.skipWhitespace();
+            }
+
+            if (parser.peek() == (open == '{' ? '}' : ']')) {
+                parser.advance();
+                stack.pop_back();
+                state = AfterValue;
+                return current = open == '{' ? EndObject : EndArray;
+            }
+
+            if (open == '{') {
+                parser.parseString(str, length);
+                parser.skipWhitespace();
+                if (parser.peek() != ':')
+                    parser.throwError("Expected ':' in JSON object");
+                parser.advance();
+                state = BeforeValue;
+                return current = Key;
+            }
+        }
+
+        parser.skipWhitespace();
+        char ch = parser.peek();
+        state = AfterValue;
+        if (ch == '{' || ch == '[') {
+            if (stack.size() >= maxDepth)
+                parser.throwError("Maximum nesting depth exceeded in JSON");
+
+            parser.advance();
+            stack.push_back(ch);
+            state = AfterOpen;
+            return current = ch == '{' ? StartObject : StartArray;
+        } else if (ch == '"') {
+            parser.parseString(str, length);
+            return current = String;
+        } else if (ch == 't' || ch == 'f') {
+            scalar.booleanValue = parser.parseBoolean();
+            return current = Boolean;
+        } else if (ch == 'n') {
+            parser.parseNull();
+            return current = Null;
+        } else if (ch == '-' || (ch >= '0' && ch <= '9')) {
+            parser.parseNumber(scalar);
+            return current = scalar.token;
+        }
+
+        parser.throwError("Unexpected character in JSON");
+    }
+
+    // Skips the value the current token starts: a whole array or object at StartObject / StartArray, or the
+    // member value after a Key. The next call to next() returns the token following it. No-op for other tokens.
+    void skip() {
+        if (current == Key) {
+            next();
+            if (current != StartObject && current != StartArray)
+                return;
+        }
+
+        if (current == StartObject || current == StartArray) {
+            parser.skipContainer();
+            parser.stack.pop_back();
+            state = AfterValue;
+            current = current == StartObject ? EndObject : EndArray;
+        }
+    }
+
+    Token token() const { return current; }
+    size_t depth() const { return parser.stack.size(); }
+
+    // Text of the current String or Key token.
+    const char* data() const { return str; }
+    size_t size() const { return length; }
+    std::string text() const { return std::string(str, length); }
+
+    bool boolean() const { return scalar.booleanValue; }
+    int64_t integer() const { return scalar.integerValue; }
+    uint64_t unsignedInteger() const { return scalar.unsignedValue; }
+    double number() const { return scalar.numberValue; }
+
+private:
+    enum State {
+        BeforeValue, // A value comes next, at the top level or after a key.
+        AfterOpen,   // Right after '{' or '[', no comma may precede the first member.
+        AfterValue,  // A member was completed.
+        Finished
+    };
+
+    // Receives numbers from the shared scanning code.
+    struct Scalar : JSONHandler {
+        Token token;
+        bool booleanValue;
+        int64_t integerValue;
+        uint64_t unsignedValue;
+        double numberValue;
+
+        bool integer(int64_t i) { token = Integer; integerValue = i; return true; }
+        bool unsignedInteger(uint64_t u) { token = UnsignedInteger; unsignedValue = u; return true; }
+        bool number(double d) { token = Double; numberValue = d; return true; }
+    };
+
+    JSONParser parser;
+    size_t maxDepth;
+    State state;
+    Token current;
+    const char* str;
+    size_t length;
+    Scalar scalar;
+};
+
+// Incremental parser for input that arrives in pieces, e.g. socket reads. Chunks are consumed as they are fed
+// and only a token split across two chunks is kept, never the payload. Events go to a handler as with
+// JSONParser::parse(data, handler), use JSONBuilder to build a JSON tree.
+template<typename Handler>
+class JSONChunkedParser {
+public:
+    JSONChunkedParser(Handler& handler, const JSONParser::Options& options = JSONParser::Options())
+    : handler(handler), maxDepth(options.maxDepth), validateUtf8(options.validateUtf8), state(Value), token(NoToken), tokenIsKey(false), escaped(false),
+      interrupted(false), offset(0), used(0), tokenStart(0), scanner(nullptr, 0) {
+        scanner.streaming = true;
+    }
+
+    JSONChunkedParser(const JSONChunkedParser&) = delete;
+    JSONChunkedParser& operator=(const JSONChunkedParser&) = delete;
+
+    // Consumes a chunk, returns true once the top level value is complete or a handler callback stopped parsing.
+    // Bytes after the end of the value are ignored, see consumed().
+    bool feed(const char* data, size_t size) {
+        size_t i = 0;
+        if (token != NoToken)
+            i = continueToken(data, size);
+
+        while (i < size && state != Done) {
+            char ch = data[i];
+            if (isspace(static_cast<unsigned char>(ch))) {
+                i++;
+                continue;
+            }
+
+            switch (state) {
+                case Comma:
+                    state = stack.back() == '{' ? ObjectStart : ArrayStart;
+                    if (ch == ',')
+                        i++;
+                    break;
+                case Colon:
+                    if (ch != ':')
+                        throwError("Expected ':' in JSON object", offset + i);
+                    state = Value;
+                    i++;
+                    break;
+                case ObjectStart:
+                    if (ch == '}') {
+                        closeContainer();
+                        i++;
+                    } else if (ch == '"') {
+                        i = startToken(data, size, i, true);
+                    } else {
+                        throwError("Expected string in JSON", offset + i);
+                    }
+                    break;
+                case ArrayStart:
+                    if (ch == ']') {
+                        closeContainer();
+                        i++;
+                        break;
+                    }
+                    state = Value;
+                    break;
+                case Value:
+                    if (ch == '{' || ch == '[') {
+                        if (stack.size() >= maxDepth)
+                            throwError("Maximum nesting depth exceeded in JSON", offset + i);
+                        stack.push_back(ch);
+                        state = ch == '{' ? ObjectStart : ArrayStart;
+                        check(ch == '{' ? handler.startObject() : handler.startArray());
+                        i++;
+                    } else if (ch == '"' || ch == '-' || (ch >= '0' && ch <= '9') || isalpha(static_cast<unsigned char>(ch))) {
+                        i = startToken(data, size, i, false);
+                    } else {
+                        throwError("Unexpected character in JSON", offset + i);
+                    }
+                    break;
+                case Done:
+                    break;
+            }
+        }
+
+        used = i;
+        offset += size;
+        return state == Done;
+    }
+
+    // Marks the end of input, which is what completes a top level number. Throws if the value is incomplete.
+    void finish() {
+        if (token == NumberToken || token == LiteralToken) {
+            token = NoToken;
+            processToken(pending.data(), pending.size());
+        }
+
+        if (state != Done)
+            throwError("Unexpected end of JSON input", offset);
+    }
+
+    bool done() const { return state == Done; }
+
+    // Bytes of the last chunk that were parsed, less than its size when the value ended inside of it.
+    size_t consumed() const { return used; }
+
+    // A handler callback returned false, so the value may not be complete.
+    bool stopped() const { return interrupted; }
+
+private:
+    enum State {
+        Value,       // A value comes next.
+        ArrayStart,  // After '[' or ',', either ']' or a value.
+        ObjectStart, // After '{' or ',', either '}' or a key.
+        Colon,
+        Comma,       // After a member, either ',' or the closing bracket.
+        Done
+    };
+
+    enum Token {
+        NoToken,
+        StringToken,
+        NumberToken,
+        LiteralToken
+    };
+
+    Handler& handler;
+    size_t maxDepth;
+    bool validateUtf8;   // Checked per string token, bytes outside strings have to be ASCII anyway.
+    State state;
+    Token token;         // Kind of the token held in pending, NoToken if none.
+    bool tokenIsKey;
+    bool escaped;        // Last byte of pending is an unconsumed backslash.
+    bool interrupted;    // A handler callback stopped parsing.
+    size_t offset;       // Stream offset of the current chunk.
+    size_t used;         // Bytes of the last chunk that were parsed.
+    size_t tokenStart;   // Stream offset of the current token.
+    std::vector<char> stack;
+    std::string pending; // Token split across chunks.
+    JSONParser scanner;  // Shared token scanning code, bound to one complete token at a time.
+
+    [[noreturn]] static void throwError(const std::string& message, size_t at) {
+        std::ostringstream oss;
+        oss << message << " at offset " << at;
+        throw std::runtime_error(oss.str());
+    }
+
+    void check(bool keepGoing) {
+        if (!keepGoing) {
+            state = Done;
+            interrupted = true;
+        }
+    }
+
+    static bool isNumberChar(char ch) {
+        return (ch >= '0' && ch <= '9') || ch == '-' || ch == '+' || ch == '.' || ch == 'e' || ch == 'E';
+    }
+
+    // Returns the offset just past the end of the current token, or size if it continues in the next chunk.
+    size_t scanToken(const char* data, size_t size, size_t i, bool& complete) {
+        complete = true;
+        if (token == StringToken) {
+            for (; i < size; ++i) {
+                if (escaped)
+                    escaped = false;
+                else if (data[i] == '\\')
+                    escaped = true;
+                else if (data[i] == '"')
+                    return i + 1;
+            }
+        } else if (token == NumberToken) {
+            while (i < size && isNumberChar(data[i]))
+                i++;
+            if (i < size)
+                return i;
+        } else {
+            while (i < size && isalpha(static_cast<unsigned char>(data[i])))
+                i++;
+            if (i < size)
+                return i;
+        }
+
+        complete = false;
+        return size;
+    }
+
+    size_t startToken(const char* data, size_t size, size_t i, bool key) {
+        char ch = data[i];
+        token = ch == '"' ? StringToken : (ch == '-' || (ch >= '0' && ch <= '9')) ? NumberToken : LiteralToken;
+        tokenIsKey = key;
+        tokenStart = offset + i;
+        escaped = false;
+
+        bool complete;
+        size_t end = scanToken(data, size, token == StringToken ? i + 1 : i, complete);
+        if (!complete) {
+            pending.assign(data + i, size - i);
+            return size;
+        }
+
+        token = NoToken;
+        processToken(data + i, end - i);
+        return end;
+    }
+
+    size_t continueToken(const char* data, size_t size) {
+        bool complete;
+        size_t end = scanToken(data, size, 0, complete);
+        pending.append(data, end);
+        if (complete) {
+            token = NoToken;
+            processToken(pending.data(), pending.size());
+        }
+        return end;
+    }
+
+    // Runs the shared scanner over one complete token and forwards the result to the handler.
+    void processToken(const char* data, size_t size) {
+        scanner.bind(data, size);
+        scanner.streamOffset = tokenStart;
+
+        char ch = data[0];
+        if (ch == '"') {
+            if (validateUtf8) {
+                size_t invalid = JSONUtf8::validate(data, size);
+                if (invalid != size)
+                    throwError("Invalid UTF-8 in JSON", tokenStart + invalid);
+            }
+
+            const char* str;
+            size_t length;
+            scanner.parseString(str, length);
+            if (tokenIsKey) {
+                state = Colon;
+                check(handler.key(str, length));
+                return;
+            }
+            check(handler.string(str, length));
+        } else if (ch == '-' || (ch >= '0' && ch <= '9')) {
+            check(scanner.parseNumber(handler));
+        } else if (ch == 't' || ch == 'f') {
+            check(handler.boolean(scanner.parseBoolean()));
+        } else if (ch == 'n') {
+            scanner.parseNull();
+            check(handler.null());
         } else {
-            return JSON(std::stoi(std::string(&data[start], pos - start)));
+            scanner.throwError("Unexpected character in JSON");
+        }
+
+        if (scanner.pos != size)
+            scanner.throwError("Unexpected character in JSON");
+        valueDone();
+    }
+
+    void closeContainer() {
+        char open = stack.back();
+        stack.pop_back();
+        state = Comma;
+        check(open == '{' ? handler.endObject() : handler.endArray());
+        valueDone();
+    }
+
+    void valueDone() {
+        if (state == Done)
+            return;
+        state = stack.empty() ? Done : Comma;
+    }
+};
+
+inline JSON JSONParser::parse(std::istream& in, const Options& options) {
+    JSON root;
+    JSONBuilder builder(root);
+    parse(in, builder, options);
+    return root;
+}
+
+// Reader for newline delimited JSON (JSON Lines). One parser and its scratch buffers are reused for every
+// record, and a malformed line is reported through failed() / error() instead of aborting the batch.
+class JSONLinesReader {
+public:
+    JSONLinesReader(const char* data, size_t size, const JSONParser::Options& options = JSONParser::Options())
+    : data(data), size(size), pos(0), line(0), origin(0), options(options), parser(nullptr, 0) {
+        parser.streaming = true;
+    }
+
+    JSONLinesReader(const std::string& data, const JSONParser::Options& options = JSONParser::Options())
+    : JSONLinesReader(data.data(), data.size(), options) {}
+    // Records are parsed from data in place, a temporary would be gone before the first next().
+    JSONLinesReader(std::string&&, const JSONParser::Options& = JSONParser::Options()) = delete;
+
+    // The mapping must outlive the reader.
+    JSONLinesReader(const JSONMappedFile& file, const JSONParser::Options& options = JSONParser::Options())
+    : JSONLinesReader(file.data(), file.size(), options) {}
+
+    JSONLinesReader(const JSONLinesReader&) = delete;
+    JSONLinesReader& operator=(const JSONLinesReader&) = delete;
+
+    // Parses the next non-blank line into value, reusing its storage where possible. Returns false once the
+    // input is exhausted. On a malformed line it still returns true with failed() set and value unspecified.
+    bool next(JSON& value) {
+        parser.builder.reset(value);
+        return next(parser.builder);
+    }
+
+    // Streams the next non-blank line to handler, see JSONHandler.
+    template<typename Handler, typename = typename std::enable_if<!std::is_same<Handler, JSON>::value>::type>
+    bool next(Handler& handler) {
+        const char* begin;
+        size_t length;
+        if (!nextLine(begin, length))
+            return false;
+
+        message.clear();
+        parser.bind(begin, length);
+        parser.streamOffset = origin + static_cast<size_t>(begin - data);
+        try {
+            if (parser.parseDocument(handler, options)) {
+                parser.skipWhitespace();
+                if (parser.pos < length)
+                    parser.throwError("Unexpected data after JSON value");
+            }
+        } catch (const std::runtime_error& e) {
+            message = e.what();
+        }
+        return true;
+    }
+
+    bool failed() const { return !message.empty(); }
+    const std::string& error() const { return message; }
+
+    // 1-based line number of the record last returned by next().
+    size_t lineNumber() const { return line; }
+
+    // Byte offset of the record last returned by next().
+    size_t offset() const { return parser.streamOffset; }
+
+private:
+    friend class JSONLinesEngine;
+
+    const char* data;
+    size_t size;
+    size_t pos;
+    size_t line;
+    size_t origin; // Offset of data within the whole input when reading one slice of it.
+    JSONParser::Options options;
+    JSONParser parser;
+    std::string message;
+
+    bool nextLine(const char*& begin, size_t& length) {
+        while (pos < size) {
+            const char* start = data + pos;
+            const char* newline = static_cast<const char*>(memchr(start, '\n', size - pos));
+            size_t end = newline ? static_cast<size_t>(newline - data) : size;
+            pos = newline ? end + 1 : size;
+            line++;
+
+            const char* p = start;
+            while (p < data + end && isspace(static_cast<unsigned char>(*p)))
+                p++;
+            if (p < data + end) {
+                begin = start;
+                length = end - static_cast<size_t>(start - data);
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+#ifndef JSON_DISABLE_THREADS
+// Parses a large JSON Lines input on a pool of worker threads. The input is cut into newline aligned chunks,
+// each chunk is parsed by its own JSONLinesReader and the records are handed to the consumer on the calling
+// thread, either in input order or as soon as a chunk is done.
+class JSONLinesEngine {
+public:
+    struct Options {
+        size_t threads;       // Worker count, 0 uses std::thread::hardware_concurrency().
+        size_t chunkSize;     // Approximate bytes per work unit.
+        size_t maxPending;    // Parsed chunks waiting for the consumer before workers pause, 0 means 2 per thread.
+        bool preserveOrder;   // Deliver records in input order.
+        JSONParser::Options parser;
+
+        Options() : threads(0), chunkSize(4 << 20), maxPending(0), preserveOrder(true) {}
+    };
+
+    struct Record {
+        JSON value;
+        size_t offset;     // Byte offset of the line within the input.
+        std::string error; // Empty unless the line is malformed.
+    };
+
+    typedef std::function<void(Record&)> Consumer;
+
+    explicit JSONLinesEngine(const Options& options = Options()) : options(options) {}
+
+    // Blocks until every record has been delivered. Exceptions thrown by the consumer stop the workers and
+    // are rethrown here.
+    void run(const char* data, size_t size, const Consumer& consumer) {
+        std::vector<std::pair<size_t, size_t> > chunks;
+        size_t chunkSize = options.chunkSize ? options.chunkSize : 1;
+        for (size_t begin = 0; begin < size;) {
+            size_t end = begin + chunkSize < size ? begin + chunkSize : size;
+            if (end < size) {
+                const char* newline = static_cast<const char*>(memchr(data + end, '\n', size - end));
+                end = newline ? static_cast<size_t>(newline - data) + 1 : size;
+            }
+            chunks.push_back(std::make_pair(begin, end));
+            begin = end;
+        }
+
+        size_t threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+        if (threads == 0)
+            threads = 1;
+        if (threads > chunks.size())
+            threads = chunks.size();
+
+        State state(chunks.size(), options.maxPending ? options.maxPending : 2 * threads);
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        try {
+            // Starting a thread can throw, the ones already running are stopped and joined below.
+            for (size_t i = 0; i < threads; ++i)
+                workers.push_back(std::thread(&JSONLinesEngine::work, this, data, std::cref(chunks), std::ref(state)));
+            deliver(state, consumer);
+        } catch (...) {
+            stop(state);
+            for (size_t i = 0; i < workers.size(); ++i)
+                workers[i].join();
+            throw;
+        }
+
+        for (size_t i = 0; i < workers.size(); ++i)
+            workers[i].join();
+        if (state.failure)
+            std::rethrow_exception(state.failure);
+    }
+
+    void run(const std::string& data, const Consumer& consumer) {
+        run(data.data(), data.size(), consumer);
+    }
+
+    void runFile(const std::string& path, const Consumer& consumer, int flags = JSONMappedFile::Sequential) {
+        JSONMappedFile file(path, flags);
+        run(file.data(), file.size(), consumer);
+    }
+
+private:
+    typedef std::deque<Record> Batch;
+
+    struct State {
+        State(size_t chunkCount, size_t window)
+        : next(0), delivered(0), chunkCount(chunkCount), window(window), stopped(false) {}
+
+        std::mutex mutex;
+        std::condition_variable ready;     // A batch finished, or the engine stopped.
+        std::condition_variable room;      // The consumer took a batch, or the engine stopped.
+        std::atomic<size_t> next;          // Next chunk to hand to a worker.
+        size_t delivered;                  // Batches handed to the consumer.
+        size_t chunkCount;
+        size_t window;
+        bool stopped;
+        std::map<size_t, Batch> done;      // Finished batches by chunk index.
+        std::exception_ptr failure;
+    };
+
+    Options options;
+
+    void work(const char* data, const std::vector<std::pair<size_t, size_t> >& chunks, State& state) {
+        try {
+            for (;;) {
+                size_t index = state.next++;
+                if (index >= state.chunkCount)
+                    return;
+
+                {
+                    // Bound memory: wait while too many finished batches are waiting for the consumer.
+                    std::unique_lock<std::mutex> lock(state.mutex);
+                    state.room.wait(lock, [&] {
+                        return state.stopped || index < state.delivered + state.window;
+                    });
+                    if (state.stopped)
+                        return;
+                }
+
+                Batch batch;
+                parseChunk(data, chunks[index].first, chunks[index].second, batch);
+
+                std::lock_guard<std::mutex> lock(state.mutex);
+                state.done[index].swap(batch);
+                state.ready.notify_all();
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (!state.failure)
+                state.failure = std::current_exception();
+            state.stopped = true;
+            state.ready.notify_all();
+            state.room.notify_all();
+        }
+    }
+
+    void parseChunk(const char* data, size_t begin, size_t end, Batch& batch) {
+        JSONLinesReader reader(data + begin, end - begin, options.parser);
+        reader.origin = begin;
+        for (;;) {
+            batch.push_back(Record());
+            Record& record = batch.back();
+            if (!reader.next(record.value)) {
+                batch.pop_back();
+                return;
+            }
+
+            record.offset = reader.offset();
+            if (reader.failed())
+                record.error = reader.error();
+        }
+    }
+
+    void deliver(State& state, const Consumer& consumer) {
+        for (size_t count = 0; count < state.chunkCount; ++count) {
+            Batch batch;
+            {
+                std::unique_lock<std::mutex> lock(state.mutex);
+                state.ready.wait(lock, [&] {
+                    if (state.stopped)
+                        return true;
+                    if (options.preserveOrder)
+                        return state.done.count(state.delivered) != 0;
+                    return !state.done.empty();
+                });
+                if (state.stopped)
+                    return;
+
+                std::map<size_t, Batch>::iterator it =
+                    options.preserveOrder ? state.done.find(state.delivered) : state.done.begin();
+                batch.swap(it->second);
+                state.done.erase(it);
+                state.delivered++;
+                state.room.notify_all();
+            }
+
+            for (Batch::iterator it = batch.begin(); it != batch.end(); ++it)
+                consumer(*it);
         }
     }
+
+    static void stop(State& state) {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.stopped = true;
+        state.room.notify_all();
+    }
 };
+#endif
 
 #endif
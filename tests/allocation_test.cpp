@@ -0,0 +1,82 @@
+// Checks that parsing builds every string and key with at most one heap allocation.
+// g++ -std=c++11 tests/allocation_test.cpp -o allocation_test && ./allocation_test
+
+#include "../json.hpp"
+
+#include <cstdio>
+#include <new>
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = std::malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+static int failures = 0;
+
+static void expect(bool condition, const char* what, size_t measured) {
+    printf("%s %s (%zu)\n", condition ? "ok  " : "FAIL", what, measured);
+    if (!condition)
+        failures++;
+}
+
+// Allocations made by parsing text, the input itself is built beforehand.
+static size_t countParse(const std::string& text) {
+    size_t before = allocations;
+    {
+        JSON json = JSONParser::parse(text);
+    }
+    return allocations - before;
+}
+
+// Keys and values are long enough to never fit in a small string buffer.
+static std::string makeObject(size_t members, bool escapes = false) {
+    std::string text = "{";
+    for (size_t i = 0; i < members; ++i) {
+        char member[128];
+        snprintf(member, sizeof(member), "%s\"a member name that needs %s storage %zu\":\"a string value that needs %s storage\"",
+                 i ? "," : "", escapes ? "\\u0068eap" : "heap", i, escapes ? "h\\u0065ap" : "heap");
+        text += member;
+    }
+    return text + "}";
+}
+
+static std::string makeArray(size_t elements) {
+    std::string text = "[";
+    for (size_t i = 0; i < elements; ++i)
+        text += i ? ",\"a string value that needs heap storage\"" : "\"a string value that needs heap storage\"";
+    return text + "]";
+}
+
+int main() {
+    const size_t n = 1000;
+
+    // One map node per member, plus at most one allocation for its key and one for its value.
+    size_t object = countParse(makeObject(2 * n)) - countParse(makeObject(n));
+    expect(object <= 3 * n, "object member: node, key and value, one allocation each", object);
+
+    // Escaped text is decoded in parser scratch and copied once into the node, no temporary per member.
+    size_t escaped = countParse(makeObject(2 * n, true)) - countParse(makeObject(n, true));
+    expect(escaped <= 3 * n, "escaped object member: node, key and value, one allocation each", escaped);
+
+    // A string element costs one allocation, the array buffer grows geometrically.
+    size_t array = countParse(makeArray(2 * n)) - countParse(makeArray(n));
+    expect(array <= n + 2, "array element: one allocation per string", array);
+
+    size_t scalar = countParse("\"a top level string that needs heap storage\"");
+    expect(scalar <= 1, "top level string: one allocation", scalar);
+
+    return failures ? 1 : 0;
+}
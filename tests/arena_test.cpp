@@ -0,0 +1,44 @@
+// Arena documents with values that do not fit the current block.
+// g++ -std=c++11 -fsanitize=address tests/arena_test.cpp -o arena_test && ./arena_test
+
+#include "../json.hpp"
+
+#include <cstdio>
+
+static int failures = 0;
+
+static void expect(bool condition, const char* what) {
+    printf("%s %s\n", condition ? "ok  " : "FAIL", what);
+    if (!condition)
+        failures++;
+}
+
+int main() {
+    // The key gets a block of its own that it fills up to the last byte, the aligned map node has to go
+    // into the next block instead of past the end of this one.
+    for (size_t length = 199990; length < 200010; ++length) {
+        std::string key(length, 'k');
+        JSONDocument doc;
+        const JSON& root = doc.parse("{\"" + key + "\":1,\"b\":[1,2,3]}");
+        if (root[key].as<int>() != 1 || root["b"][size_t(2)].as<int>() != 3) {
+            expect(false, "oversized key next to aligned allocations");
+            return 1;
+        }
+    }
+    expect(true, "oversized key next to aligned allocations");
+
+    JSONArena arena;
+    for (size_t size = 1; size < 300000; size = size * 3 + 1) {
+        char* bytes = static_cast<char*>(arena.allocate(size, 1));
+        memset(bytes, 'x', size);
+        void* word = arena.allocate(sizeof(uint64_t), alignof(uint64_t));
+        memset(word, 0, sizeof(uint64_t));
+        if (reinterpret_cast<uintptr_t>(word) % alignof(uint64_t) != 0) {
+            expect(false, "aligned allocation after an unaligned one");
+            return 1;
+        }
+    }
+    expect(true, "aligned allocation after an unaligned one");
+
+    return failures ? 1 : 0;
+}
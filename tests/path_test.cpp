@@ -0,0 +1,30 @@
+// JSONParser::parsePaths() with nested and sibling pointers.
+// g++ -std=c++11 tests/path_test.cpp -o path_test && ./path_test
+
+#include "../json.hpp"
+
+#include <cstdio>
+
+static int failures = 0;
+
+static void expect(bool condition, const char* what) {
+    printf("%s %s\n", condition ? "ok  " : "FAIL", what);
+    if (!condition)
+        failures++;
+}
+
+int main() {
+    // Pointers found inside a value that was built in full must count once each, or parsing stops before "/z".
+    std::map<std::string, JSON> nested = JSONParser::parsePaths("{\"a\":{\"b\":{\"c\":1}},\"z\":2}", {"/a", "/a/b", "/a/b/c", "/z"});
+    expect(nested.size() == 4, "nested pointers followed by a sibling are all found");
+    expect(nested.count("/z") && nested["/z"].as<int>() == 2, "sibling after nested pointers has its value");
+    expect(nested.count("/a/b/c") && nested["/a/b/c"].as<int>() == 1, "innermost nested pointer has its value");
+
+    std::map<std::string, JSON> items = JSONParser::parsePaths("{\"items\":[{\"p\":1},{\"p\":2},{\"p\":3}],\"n\":3}",
+                                                                {"/items/1", "/items/1/p", "/items/2/p", "/n", "/items/7"});
+    expect(items.size() == 4, "array pointers with a nested one and a missing index");
+    expect(items.count("/n") && items["/n"].as<int>() == 3, "pointer after the array is found");
+    expect(!items.count("/items/7"), "index past the end is left out");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,45 @@
+// JSONParser::parse(std::istream&) stops right after the value, so values sent back to back are all read.
+// g++ -std=c++11 tests/stream_test.cpp -o stream_test && ./stream_test
+
+#include "../json.hpp"
+
+#include <cstdio>
+
+static int failures = 0;
+
+static void expect(bool condition, const char* what) {
+    printf("%s %s\n", condition ? "ok  " : "FAIL", what);
+    if (!condition)
+        failures++;
+}
+
+int main() {
+    std::istringstream values("{\"a\":1}[2,3] \"s\"\n42 true{\"b\":[\"x\"]}7");
+    expect(JSONParser::parse(values).dump(0) == "{\"a\":1}", "first object");
+    expect(JSONParser::parse(values).dump(0) == "[2, 3]", "array right after it");
+    expect(JSONParser::parse(values).dump(0) == "\"s\"", "string");
+    expect(JSONParser::parse(values).as<int>() == 42, "number ended by a newline");
+    expect(JSONParser::parse(values).as<bool>(), "literal");
+    expect(JSONParser::parse(values).dump(0) == "{\"b\":[\"x\"]}", "object glued to the literal");
+    expect(JSONParser::parse(values).as<int>() == 7, "number ended by the end of the stream");
+
+    // The first value spans many buffer refills, the one after it must still be there.
+    std::string text = "[";
+    for (int i = 0; i < 100000; ++i)
+        text += (i ? "," : "") + std::to_string(i);
+    std::istringstream large(text + "] {\"after\":1}");
+    JSON first = JSONParser::parse(large);
+    expect(first[size_t(99999)].as<int>() == 99999, "large value");
+    expect(JSONParser::parse(large)["after"].as<int>() == 1, "value after a large one");
+
+    std::istringstream truncated("[1,");
+    bool threw = false;
+    try {
+        JSONParser::parse(truncated);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    expect(threw && truncated.eof(), "incomplete value throws at the end of the stream");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,56 @@
+// Options::structuralIndex gives the same values and errors as the byte by byte parser.
+// g++ -std=c++11 -O2 -march=native tests/structural_test.cpp -o structural_test && ./structural_test
+
+#include "../json.hpp"
+
+#include <cstdio>
+
+static int failures = 0;
+
+static void expect(bool condition, const char* what) {
+    printf("%s %s\n", condition ? "ok  " : "FAIL", what);
+    if (!condition)
+        failures++;
+}
+
+// The dump of the parsed value, or the error message.
+static std::string parse(const std::string& text, bool indexed) {
+    JSONParser::Options options;
+    options.structuralIndex = indexed;
+    try {
+        return JSONParser::parse(text.data(), text.size(), options).dump(0);
+    } catch (const std::exception& e) {
+        return e.what();
+    }
+}
+
+static void same(const std::string& text, const char* what) {
+    expect(parse(text, false) == parse(text, true), what);
+}
+
+int main() {
+    same("{\"a\":[1,-2.5e3,true,false,null,\"x\"],\"b\":{\"c\":{}},\"d\":[]}", "values of every type");
+    same("\"top\"", "top level string");
+    same("42", "top level number");
+    same("[\"a\\\"b\\\\\",\"\\u00e9\\ud83d\\ude00\"]", "escapes and surrogate pairs");
+    same(" \f[\v1\f,\r\n2\t]", "vertical tab and form feed are whitespace as for isspace()");
+
+    // Only the first byte of a run of scalar characters is indexed.
+    same("[truefalse,null1]", "scalars without a comma between them");
+    same("[1x]", "garbage after a number");
+    same("{\"a\":1x}", "garbage after a member value");
+    same("[1,2,]", "trailing comma");
+    same("{\"a\" \"b\"}", "missing colon");
+    same("[\"abc", "unterminated string");
+    same("[\"a\\q", "bad escape in an unterminated string");
+    same("[1,2", "unterminated array");
+
+    // Strings and escape runs that cross 64 byte blocks.
+    std::string blocks = "[";
+    for (int i = 0; i < 200; ++i)
+        blocks += (i ? ",\"" : "\"") + std::string(i % 67, 'z') + std::string(i % 3 * 2, '\\') + (i % 2 ? "\\\"" : "") + "\"";
+    same(blocks + "]", "strings across blocks");
+    same(blocks, "array of such strings left open");
+
+    return failures ? 1 : 0;
+}